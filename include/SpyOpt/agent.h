@@ -5,6 +5,7 @@
 #include <functional>
 #include <random>
 #include <iostream>
+#include <limits>
 
 namespace spy_opt
 {
@@ -15,21 +16,26 @@ class Agent
 public:
     explicit Agent(size_t id,
                    const std::vector<double> init_pos,
-                   std::function<double(const std::vector<double>&)> objective_func,
                    const std::vector<double> lower_bounds,
                    const std::vector<double> upper_bounds,
-                   size_t max_iteration,
                    const std::mt19937 &rand_engine);
     size_t id;
     double fitness;
-    std::vector<std::vector<double>> pos_history;
-    std::vector<double> fitness_history;
 
+    // The moves only update the position. The new fitness is given by evaluated()
+    // once the whole population has been evaluated in one batch.
     void reset(const std::vector<double> &init_pos);
     void swingMove(size_t time, double swing_factor);
-    void moveToward(const Agent &better_agent);
+    void swingMove(double step);
+    void moveToward(const std::vector<double> &better_pos);
     void randomSearch();
+    // greedy: go back to the position before the move if the new fitness does not improve
+    void evaluated(double new_fitness, bool greedy);
+    // Move to a position evaluated elsewhere (e.g. local refinement).
+    void relocate(const std::vector<double> &pos, double new_fitness);
     const std::vector<double>& getPosition() const;
+    // Position before the last move, i.e. the one a greedy move reverts to
+    const std::vector<double>& getPreviousPosition() const;
 
     friend bool operator<(const Agent &lhs, const Agent &rhs);
     friend std::ostream& operator<<(std::ostream &os, const Agent &agent);
@@ -37,9 +43,8 @@ public:
 private:
     void clipPosition();
 
-    std::vector<double> position_;
+    std::vector<double> position_, prev_position_;
     std::vector<double> lower_bounds_, upper_bounds_;
-    std::function<double(const std::vector<double>&)> objective_func_;
 
     std::mt19937 rand_engine_;
 };
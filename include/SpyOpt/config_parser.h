@@ -3,11 +3,13 @@
 
 #include <yaml-cpp/yaml.h>
 #include "SpyOpt/spy_opt.h"
+#include "SpyOpt/sweep.h"
 
 namespace spy_opt
 {
 
 [[nodiscard]] bool parseConfig(const std::string &config_path, Config &config);
+[[nodiscard]] bool parseSweepConfig(const std::string &config_path, SweepConfig &sweep_config);
 
 template <typename T>
 bool safeLoadScalar(const YAML::Node &node, const std::string &key, T &value)
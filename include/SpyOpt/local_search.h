@@ -0,0 +1,64 @@
+#ifndef SPY_OPT__LOCAL_SEARCH_H
+#define SPY_OPT__LOCAL_SEARCH_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace spy_opt
+{
+
+enum class LocalSearchMethod
+{
+    None,
+    NelderMead,
+    PatternSearch,
+    QuasiNewton  // BFGS with forward-difference gradients
+};
+// Throws std::runtime_error for an unknown name.
+LocalSearchMethod toLocalSearchMethod(const std::string &name);
+
+struct LocalSearchResult
+{
+    std::vector<double> position;
+    double fitness;
+};
+
+// Bounded local optimizer used to refine the elite agents.
+// Every candidate is clipped into the bounds before evaluation.
+class LocalSearch
+{
+
+public:
+    explicit LocalSearch(LocalSearchMethod method,
+                         std::function<double(const std::vector<double>&)> objective_func,
+                         const std::vector<double> &lower_bounds,
+                         const std::vector<double> &upper_bounds);
+
+    // Start from (init_pos, init_fitness) and spend at most max_evaluations evaluations.
+    // The result is never worse than the start point.
+    // num_evaluations is incremented before each objective call, so it stays exact if the objective throws.
+    LocalSearchResult refine(const std::vector<double> &init_pos,
+                             double init_fitness,
+                             double initial_step,
+                             size_t max_evaluations,
+                             size_t &num_evaluations) const;
+    LocalSearchMethod getMethod() const;
+
+private:
+    LocalSearchResult nelderMead(const std::vector<double> &init_pos, double init_fitness,
+                                 double initial_step, size_t max_evaluations, size_t &num_evaluations) const;
+    LocalSearchResult patternSearch(const std::vector<double> &init_pos, double init_fitness,
+                                    double initial_step, size_t max_evaluations, size_t &num_evaluations) const;
+    LocalSearchResult quasiNewton(const std::vector<double> &init_pos, double init_fitness,
+                                  double initial_step, size_t max_evaluations, size_t &num_evaluations) const;
+    void clipPosition(std::vector<double> &pos) const;
+
+    LocalSearchMethod method_;
+    std::function<double(const std::vector<double>&)> objective_func_;
+    std::vector<double> lower_bounds_, upper_bounds_;
+};
+
+} // namespace spy_opt
+
+#endif
@@ -1,9 +1,12 @@
 #ifndef SPY_OPT__SPY_OPT_H
 #define SPY_OPT__SPY_OPT_H
 
+#include <array>
+#include <optional>
 #include <string>
 #include <vector>
 #include "SpyOpt/agent.h"
+#include "SpyOpt/local_search.h"
 
 namespace spy_opt
 {
@@ -17,46 +20,150 @@ struct Config
     double swing_factor;
     std::vector<double> lower_bounds, upper_bounds;
     size_t input_dim;
+
+    // Adapt the swing step and the high/mid rank split online from the
+    // success rate of each band (fraction of moves that improve fitness). Each band's rate
+    // is compared against its own long-term average, and each band keeps at least half
+    // of its configured size.
+    // Swing moves of the high rank agents become greedy in this mode.
+    bool adaptive_control = false;
+
+    // Local refinement of the top agents. Runs every 'refinement_interval' iterations
+    // and/or when the best fitness has not improved for 'refinement_stall' iterations.
+    // The swing moves of a refined agent are greedy while it stays in the high rank band,
+    // so that the refined position is only replaced by a better one.
+    std::string refinement_method = "None";  // None, NelderMead, PatternSearch, QuasiNewton
+    size_t refinement_interval = 0;          // 0: disabled
+    size_t refinement_stall = 0;             // 0: disabled
+    size_t num_refined_agents = 1;
+    size_t refinement_evaluations = 100;     // Max evaluations per refined agent
+
+    size_t max_evaluations = 0;  // Total evaluation budget including refinement. 0: unlimited
+
+    std::optional<unsigned int> seed;  // Seeded from std::random_device if empty
+    bool verbose = true;               // Print the progress bar
 };
 std::ostream& operator<<(std::ostream &os, const Config &config);
 
+// Evaluates num_positions positions stored row-major in 'positions'
+// (num_positions x dim) and writes their fitness to 'fitness'.
+using BatchObjectiveFunction =
+    std::function<void(const double *positions, size_t num_positions, size_t dim, double *fitness)>;
+
 class SpyOpt
 {
 
 public:
     explicit SpyOpt(const Config &config,
                     std::function<double(const std::vector<double>&)> objective_func);
+    // The whole population is evaluated with one call per iteration.
+    explicit SpyOpt(const Config &config,
+                    BatchObjectiveFunction batch_objective_func);
+    // Without an objective function: drive the optimization with ask() and tell() only.
+    explicit SpyOpt(const Config &config);
+
+    // Thin wrappers over ask() and tell() that evaluate with the objective function.
+    // If the objective throws while evaluating the population, the candidates stay pending and
+    // the next step() evaluates them again. If it throws during refinement, the iteration is
+    // completed with the refinement done so far and the exception is rethrown.
     void optimize();
+    // Run one iteration. return: false if no iteration is left or the evaluation budget is exhausted.
+    bool step();
+
+    // Ask/tell interface
+    // ask(): candidates to evaluate, row-major (num_agents x dim) in rank order:
+    //        [0, num_high_rank) swing, then num_mid_rank moving toward better agents, then random search.
+    //        The first ask() of a run returns the initial population. Asking again before tell()
+    //        returns the same candidates. The buffer is reused by the next ask().
+    // tell(): one fitness value per candidate, in the same order. Advances the iteration.
+    //         NaN marks a failed evaluation and is stored as +inf (the worst fitness).
+    const std::vector<double>& ask();
+    void tell(const double *fitness, size_t num_fitness);
+    void tell(const std::vector<double> &fitness);
+    bool isFinished() const;
+
     void reset();
 
+    // Throws std::runtime_error if 'config' cannot be used to construct SpyOpt.
+    static void validateConfig(const Config &config);
+
     // return: [fitness, position]
     std::pair<double, std::vector<double>> getBestFitness() const;
+    size_t getNumEvaluations() const;
+    size_t getIteration() const;
+    const Config& getConfig() const;
+
+    // Contiguous, row-major histories. One row is appended per iteration.
+    // Storage for 'num_iterations' rows is reserved, so the data does not move.
+    const std::vector<double>& getBestFitnessHistory() const;    // [iteration]
+    const std::vector<double>& getBestPositionHistory() const;   // [iteration][dim]
+    const std::vector<double>& getAgentsFitnessHistory() const;  // [iteration][agent id]
+    const std::vector<double>& getAgentsPositionHistory() const; // [iteration][agent id][dim]
 
     void printAgents() const;
     void printBestAgent() const;
-    void dumpAgentsHistory(const std::string &filename);
-    void dumpBestSolutionHistory(const std::string &filename);
+    void dumpAgentsHistory(const std::string &filename) const;
+    void dumpBestSolutionHistory(const std::string &filename) const;
 
 private:
-    void generateAgents(std::function<double(const std::vector<double>&)> objective_func);
+    explicit SpyOpt(const Config &config,
+                    std::function<double(const std::vector<double>&)> objective_func,
+                    BatchObjectiveFunction batch_objective_func);
+    void generateAgents();
+    void moveAgents();
     void sortAgentsByFitness();
-    void sortAgentsByID();
-    void validateConfig() const;
     std::vector<double> generateRandomPosition();
     void printInitialConditions() const;
     void printFinalConditions() const;
     void printProgress(size_t iteration);
+    void reserveHistory();
     void updateHistory();
+    void initAdaptiveState();
+    void adaptParameters(const std::array<size_t, 2> &num_success);
+    bool isRefinementDue(size_t iteration) const;
+    void refineEliteAgents(double initial_step);
+    bool isSwingGreedy(const Agent &agent) const;
+    size_t getRemainingEvaluations() const;
+
+    // Adaptive control
+    static constexpr double TARGET_SUCCESS_RATE = 0.2;  // 1/5th success rule
+    static constexpr double STEP_ADAPT_FACTOR = 0.85;
+    static constexpr double SUCCESS_RATE_SMOOTHING = 0.3;
+    static constexpr double BASELINE_SMOOTHING = 0.05;  // Long-term success rate of each band
+    static constexpr double BAND_SHIFT_MARGIN = 0.25;
+    static constexpr double MIN_BAND_FRACTION = 0.5;    // of the configured band size
 
     std::vector<Agent> agents_;
     std::vector<double> best_fitness_history_;
-    std::vector<std::vector<double>> best_pos_history_;
+    std::vector<double> best_pos_history_;
+    std::vector<double> agents_fitness_history_;
+    std::vector<double> agents_pos_history_;
+
+    // Candidates of the pending ask() and their fitness, in the current rank order
+    std::vector<double> candidates_;
+    std::vector<double> candidate_fitness_;
 
     std::mt19937 rand_engine_;
     std::uniform_real_distribution<> uniform_dist_;
 
     Config config_;
+    std::function<double(const std::vector<double>&)> objective_func_;
+    BatchObjectiveFunction batch_objective_func_;
+    LocalSearch local_search_;
+    size_t iteration_ = 0;  // 0 until the initial population is told
+    bool asked_ = false;
     size_t last_printed_progress_ = 0;
+    size_t num_evaluations_ = 0;
+    size_t num_stalled_iterations_ = 0;
+    double best_fitness_so_far_ = std::numeric_limits<double>::infinity();
+    std::vector<bool> refined_agents_;  // by agent id. Cleared when the agent leaves the high rank band.
+
+    // Rank band sizes and swing step. Fixed unless 'adaptive_control' is enabled.
+    size_t num_high_rank_, num_mid_rank_;
+    double swing_step_;
+    double min_swing_step_, max_swing_step_;
+    std::array<double, 2> success_rates_;   // smoothed, {high, mid}
+    std::array<double, 2> baseline_rates_;  // slowly smoothed, {high, mid}
 };
 
 } // namespace spy_opt
@@ -0,0 +1,116 @@
+#ifndef SPY_OPT__SPY_OPT_C_H
+#define SPY_OPT__SPY_OPT_C_H
+
+/*
+ * C API of SpyOpt.
+ *
+ * Functions returning int return SPYOPT_OK on success and SPYOPT_ERROR on failure.
+ * The message of the last failure on the calling thread is given by spyopt_last_error().
+ * No C++ exception crosses this interface.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPYOPT_OK 0
+#define SPYOPT_ERROR (-1)
+
+typedef struct spyopt_t spyopt_t;
+
+typedef struct spyopt_config_t
+{
+    size_t num_agents;
+    size_t num_high_rank;
+    size_t num_mid_rank;
+    size_t num_iterations;
+    double swing_factor;
+    size_t input_dim;
+    const double *lower_bounds;  /* input_dim elements, copied by spyopt_create*() */
+    const double *upper_bounds;  /* input_dim elements, copied by spyopt_create*() */
+
+    int adaptive_control;
+
+    const char *refinement_method;  /* "None", "NelderMead", "PatternSearch", "QuasiNewton" */
+    size_t refinement_interval;
+    size_t refinement_stall;
+    size_t num_refined_agents;
+    size_t refinement_evaluations;
+    size_t max_evaluations;
+
+    int use_seed;
+    unsigned int seed;
+    int verbose;
+} spyopt_config_t;
+
+/* Evaluate one position of input_dim elements. */
+typedef double (*spyopt_objective_fn)(const double *position, size_t dim, void *user_data);
+
+/*
+ * Evaluate num_positions positions stored row-major (num_positions x dim) and write
+ * their fitness to 'fitness'. 'positions' is only valid during the call.
+ * Return nonzero to abort; the calling function then returns SPYOPT_ERROR. If the population
+ * was being evaluated, the pending candidates are kept, so the next step evaluates them again.
+ * If the call was from local refinement (one position at a time), the iteration is completed
+ * with the refinement done so far.
+ */
+typedef int (*spyopt_batch_objective_fn)(const double *positions, size_t num_positions, size_t dim,
+                                         double *fitness, void *user_data);
+
+/* Fill with the defaults of resources/config.yaml. Bounds are left NULL. */
+void spyopt_config_init(spyopt_config_t *config);
+
+/* return: NULL on failure */
+spyopt_t *spyopt_create(const spyopt_config_t *config, spyopt_objective_fn objective_func, void *user_data);
+spyopt_t *spyopt_create_batch(const spyopt_config_t *config, spyopt_batch_objective_fn batch_objective_func,
+                              void *user_data);
+/* Without an objective function: drive the optimization with spyopt_ask() and spyopt_tell() only. */
+spyopt_t *spyopt_create_ask_tell(const spyopt_config_t *config);
+void spyopt_destroy(spyopt_t *opt);
+
+/* Run the remaining iterations. */
+int spyopt_optimize(spyopt_t *opt);
+/* Run up to num_steps iterations. num_done (nullable) receives the number actually run;
+ * it is smaller than num_steps once the run is finished or the evaluation budget is exhausted. */
+int spyopt_step(spyopt_t *opt, size_t num_steps, size_t *num_done);
+int spyopt_reset(spyopt_t *opt);
+
+/*
+ * Ask/tell interface.
+ * spyopt_ask() returns the candidates to evaluate, row-major (num_candidates x input_dim),
+ * without copying. The buffer is owned by 'opt' and reused by the next ask. Asking again
+ * before telling returns the same candidates. Returns NULL on failure (e.g. finished).
+ * spyopt_tell() takes one fitness value per candidate, in the same order. NaN marks a
+ * failed evaluation and is stored as +inf (the worst fitness).
+ */
+const double *spyopt_ask(spyopt_t *opt, size_t *num_candidates);
+int spyopt_tell(spyopt_t *opt, const double *fitness, size_t num_fitness);
+/* return: 1 if no iteration is left or the evaluation budget is exhausted, 0 otherwise */
+int spyopt_finished(const spyopt_t *opt);
+
+/* position (nullable) receives input_dim elements. */
+int spyopt_get_best(const spyopt_t *opt, double *fitness, double *position);
+size_t spyopt_num_evaluations(const spyopt_t *opt);
+size_t spyopt_iteration(const spyopt_t *opt);
+size_t spyopt_input_dim(const spyopt_t *opt);
+size_t spyopt_num_agents(const spyopt_t *opt);
+
+/*
+ * Views of the internal, row-major history buffers. num_rows (nullable) receives the
+ * number of recorded iterations. The pointers stay valid until spyopt_reset() or
+ * spyopt_destroy().
+ */
+const double *spyopt_best_fitness_history(const spyopt_t *opt, size_t *num_rows);    /* [row] */
+const double *spyopt_best_position_history(const spyopt_t *opt, size_t *num_rows);   /* [row][dim] */
+const double *spyopt_agents_fitness_history(const spyopt_t *opt, size_t *num_rows);  /* [row][agent id] */
+const double *spyopt_agents_position_history(const spyopt_t *opt, size_t *num_rows); /* [row][agent id][dim] */
+
+const char *spyopt_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
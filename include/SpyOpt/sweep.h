@@ -0,0 +1,94 @@
+#ifndef SPY_OPT__SWEEP_H
+#define SPY_OPT__SWEEP_H
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SpyOpt/spy_opt.h"
+
+namespace spy_opt
+{
+
+struct SweepConfig
+{
+    std::string base_config_path;
+    size_t num_seeds;
+    unsigned int seed = 0;          // Seed of the first run. Run k uses (seed + k) for every configuration.
+    size_t num_threads = 0;         // 0: std::thread::hardware_concurrency()
+    size_t prune_after = 0;         // Minimum number of runs before a configuration may be pruned. 0: no pruning
+    size_t num_random_samples = 0;  // Number of random draws per grid point
+    std::string output_path;
+
+    // Parameter name -> values (grid) or [min, max] (random)
+    std::map<std::string, std::vector<double>> grid;
+    std::map<std::string, std::pair<double, double>> random_ranges;
+};
+std::ostream& operator<<(std::ostream &os, const SweepConfig &sweep_config);
+
+struct SweepStatistics
+{
+    double mean, stddev, min, median, max;
+};
+
+struct SweepResult
+{
+    Config config;
+    std::vector<double> fitness;       // Best fitness of each finished run
+    std::vector<size_t> evaluations;   // Objective evaluations of each finished run
+    SweepStatistics stats;             // of 'fitness', updated with each finished run
+    double mean_evaluations = 0.;
+    bool pruned = false;
+    std::string error;                 // First failure. The remaining runs are skipped.
+};
+
+class HyperparameterSweep
+{
+
+public:
+    explicit HyperparameterSweep(const Config &base_config,
+                                 const SweepConfig &sweep_config,
+                                 std::function<double(const std::vector<double>&)> objective_func);
+
+    // Run every configuration x seed in parallel.
+    void run();
+
+    const std::vector<SweepResult>& getResults() const;
+    // The best mean fitness among configurations with about the same evaluation budget, for each budget
+    void printBestConfig() const;
+    void dumpResults(const std::string &filename) const;
+
+    static bool isSweepableParameter(const std::string &name);
+
+private:
+    void expandConfigs(const Config &base_config);
+    void runWorker();
+    void addRun(size_t config_id, double fitness, size_t num_evaluations);
+    void updatePruning(size_t config_id);
+    bool isPruningCandidate(const SweepResult &result) const;
+    // true if 'result' is worse than 'other' with confidence and both have about the same budget
+    static bool isDominated(const SweepResult &result, const SweepResult &other);
+    std::vector<Config> sampleRandomRanges(const Config &config, std::mt19937 &rand_engine) const;
+    static void setParameter(Config &config, const std::string &name, double value);
+    static bool isIntegerParameter(const std::string &name);  // Including adaptive_control (0 or 1)
+
+    // Pruning compares configurations whose mean evaluations per run differ by at most this fraction
+    static constexpr double PRUNE_BUDGET_TOLERANCE = 0.05;
+    static constexpr double PRUNE_CONFIDENCE_Z = 3.;
+
+    SweepConfig sweep_config_;
+    std::function<double(const std::vector<double>&)> objective_func_;
+    std::vector<SweepResult> results_;
+
+    // Jobs are ordered seed-major so that all configurations progress evenly and
+    // can be compared for pruning early.
+    size_t next_job_ = 0;
+    size_t num_finished_jobs_ = 0;
+    std::mutex mutex_;
+};
+
+} // namespace spy_opt
+
+#endif
@@ -0,0 +1,535 @@
+// Python extension module 'spyopt', built on the C API (SpyOpt/spy_opt_c.h).
+//
+// The objective is called once per population with a read-only (num_agents, dim)
+// numpy view of the candidate buffer (also returned by ask()), and the histories are exposed as read-only
+// numpy views of the internal buffers. No data is copied in either direction
+// except the fitness values returned by the objective.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+
+#include <climits>
+#include <cstring>
+#include <string>
+
+#include "SpyOpt/spy_opt_c.h"
+
+namespace
+{
+
+struct SpyOptObject
+{
+    PyObject_HEAD
+    spyopt_t *opt;
+    PyObject *objective;
+    bool vectorized;
+    bool in_call;  // Guards against re-entrant calls from the objective
+};
+
+// Read-only view of 'data' that keeps 'owner' alive.
+PyObject *makeView(PyObject *owner, const double *data, int ndim, npy_intp *dims)
+{
+    PyObject *array = PyArray_SimpleNewFromData(ndim, dims, NPY_DOUBLE, const_cast<double *>(data));
+    if (array == nullptr)
+    {
+        return nullptr;
+    }
+    PyArray_CLEARFLAGS(reinterpret_cast<PyArrayObject *>(array), NPY_ARRAY_WRITEABLE);
+    Py_INCREF(owner);
+    if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject *>(array), owner) < 0)
+    {
+        Py_DECREF(array);
+        return nullptr;
+    }
+    return array;
+}
+
+int batchObjective(const double *positions, size_t num_positions, size_t dim, double *fitness, void *user_data)
+{
+    auto *self = static_cast<SpyOptObject *>(user_data);
+    npy_intp dims[2] = {static_cast<npy_intp>(num_positions), static_cast<npy_intp>(dim)};
+    PyObject *view = makeView(reinterpret_cast<PyObject *>(self), positions, 2, dims);
+    if (view == nullptr)
+    {
+        return -1;
+    }
+
+    if (!self->vectorized)
+    {
+        for (size_t i = 0; i < num_positions; ++i)
+        {
+            PyObject *row = PySequence_GetItem(view, static_cast<Py_ssize_t>(i));
+            PyObject *result = row != nullptr ? PyObject_CallOneArg(self->objective, row) : nullptr;
+            Py_XDECREF(row);
+            if (result == nullptr)
+            {
+                Py_DECREF(view);
+                return -1;
+            }
+            fitness[i] = PyFloat_AsDouble(result);
+            Py_DECREF(result);
+            if (fitness[i] == -1. && PyErr_Occurred())
+            {
+                Py_DECREF(view);
+                return -1;
+            }
+        }
+        Py_DECREF(view);
+        return 0;
+    }
+
+    PyObject *result = PyObject_CallOneArg(self->objective, view);
+    Py_DECREF(view);
+    if (result == nullptr)
+    {
+        return -1;
+    }
+    PyObject *values = PyArray_FROMANY(result, NPY_DOUBLE, 0, 1, NPY_ARRAY_IN_ARRAY);
+    Py_DECREF(result);
+    if (values == nullptr)
+    {
+        return -1;
+    }
+    if (static_cast<size_t>(PyArray_SIZE(reinterpret_cast<PyArrayObject *>(values))) != num_positions)
+    {
+        PyErr_Format(PyExc_ValueError, "objective returned %zd values for %zu positions",
+                     PyArray_SIZE(reinterpret_cast<PyArrayObject *>(values)), num_positions);
+        Py_DECREF(values);
+        return -1;
+    }
+    std::memcpy(fitness, PyArray_DATA(reinterpret_cast<PyArrayObject *>(values)), num_positions * sizeof(double));
+    Py_DECREF(values);
+    return 0;
+}
+
+// Turn a failed C API call into a Python exception. An exception raised by the
+// objective is already set and takes precedence.
+PyObject *raiseError()
+{
+    if (!PyErr_Occurred())
+    {
+        PyErr_SetString(PyExc_RuntimeError, spyopt_last_error());
+    }
+    return nullptr;
+}
+
+bool enterCall(SpyOptObject *self)
+{
+    if (self->opt == nullptr)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "SpyOpt is not initialized");
+        return false;
+    }
+    if (self->in_call)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "SpyOpt cannot be driven from inside its objective");
+        return false;
+    }
+    self->in_call = true;
+    return true;
+}
+
+/* Type slots */
+
+int SpyOpt_traverse(SpyOptObject *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->objective);
+    return 0;
+}
+
+int SpyOpt_clear(SpyOptObject *self)
+{
+    Py_CLEAR(self->objective);
+    return 0;
+}
+
+void SpyOpt_dealloc(SpyOptObject *self)
+{
+    PyObject_GC_UnTrack(self);
+    spyopt_destroy(self->opt);
+    self->opt = nullptr;
+    SpyOpt_clear(self);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject *>(self));
+}
+
+int SpyOpt_init(SpyOptObject *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {
+        "objective", "lower_bounds", "upper_bounds",
+        "num_agents", "num_high_rank", "num_mid_rank", "num_iterations", "swing_factor",
+        "adaptive_control", "refinement_method", "refinement_interval", "refinement_stall",
+        "num_refined_agents", "refinement_evaluations", "max_evaluations",
+        "seed", "verbose", "vectorized", nullptr};
+
+    // Views returned earlier keep 'self' alive, not the buffers of a replaced optimizer
+    if (self->opt != nullptr || self->in_call)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "SpyOpt cannot be re-initialized");
+        return -1;
+    }
+
+    spyopt_config_t config;
+    spyopt_config_init(&config);
+    PyObject *objective = nullptr, *lower_obj = nullptr, *upper_obj = nullptr, *seed_obj = Py_None;
+    Py_ssize_t num_agents = config.num_agents, num_high_rank = config.num_high_rank;
+    Py_ssize_t num_mid_rank = config.num_mid_rank, num_iterations = config.num_iterations;
+    Py_ssize_t refinement_interval = config.refinement_interval, refinement_stall = config.refinement_stall;
+    Py_ssize_t num_refined_agents = config.num_refined_agents;
+    Py_ssize_t refinement_evaluations = config.refinement_evaluations, max_evaluations = 0;
+    int adaptive_control = 0, verbose = 0, vectorized = 1;
+    const char *refinement_method = config.refinement_method;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|$nnnndpsnnnnnOpp", const_cast<char **>(keywords),
+                                     &objective, &lower_obj, &upper_obj,
+                                     &num_agents, &num_high_rank, &num_mid_rank, &num_iterations,
+                                     &config.swing_factor, &adaptive_control, &refinement_method,
+                                     &refinement_interval, &refinement_stall, &num_refined_agents,
+                                     &refinement_evaluations, &max_evaluations,
+                                     &seed_obj, &verbose, &vectorized))
+    {
+        return -1;
+    }
+    if (objective != Py_None && !PyCallable_Check(objective))
+    {
+        PyErr_SetString(PyExc_TypeError, "objective should be callable or None");
+        return -1;
+    }
+    for (const Py_ssize_t value : {num_agents, num_high_rank, num_mid_rank, num_iterations, refinement_interval,
+                                   refinement_stall, num_refined_agents, refinement_evaluations, max_evaluations})
+    {
+        if (value < 0)
+        {
+            PyErr_SetString(PyExc_ValueError, "counts should not be negative");
+            return -1;
+        }
+    }
+
+    PyObject *lower = PyArray_FROMANY(lower_obj, NPY_DOUBLE, 1, 1, NPY_ARRAY_IN_ARRAY);
+    PyObject *upper = lower != nullptr ? PyArray_FROMANY(upper_obj, NPY_DOUBLE, 1, 1, NPY_ARRAY_IN_ARRAY) : nullptr;
+    if (upper == nullptr)
+    {
+        Py_XDECREF(lower);
+        return -1;
+    }
+    const npy_intp dim = PyArray_SIZE(reinterpret_cast<PyArrayObject *>(lower));
+    if (dim != PyArray_SIZE(reinterpret_cast<PyArrayObject *>(upper)))
+    {
+        PyErr_SetString(PyExc_ValueError, "lower_bounds and upper_bounds should have the same length");
+        Py_DECREF(lower);
+        Py_DECREF(upper);
+        return -1;
+    }
+
+    config.num_agents = num_agents;
+    config.num_high_rank = num_high_rank;
+    config.num_mid_rank = num_mid_rank;
+    config.num_iterations = num_iterations;
+    config.input_dim = dim;
+    config.lower_bounds = static_cast<const double *>(PyArray_DATA(reinterpret_cast<PyArrayObject *>(lower)));
+    config.upper_bounds = static_cast<const double *>(PyArray_DATA(reinterpret_cast<PyArrayObject *>(upper)));
+    config.adaptive_control = adaptive_control;
+    config.refinement_method = refinement_method;
+    config.refinement_interval = refinement_interval;
+    config.refinement_stall = refinement_stall;
+    config.num_refined_agents = num_refined_agents;
+    config.refinement_evaluations = refinement_evaluations;
+    config.max_evaluations = max_evaluations;
+    config.verbose = verbose;
+    if (seed_obj != Py_None)
+    {
+        const unsigned long seed = PyLong_AsUnsignedLong(seed_obj);
+        if (!PyErr_Occurred() && seed > UINT_MAX)
+        {
+            PyErr_SetString(PyExc_OverflowError, "seed should be in [0, 2**32 - 1]");
+        }
+        if (PyErr_Occurred())
+        {
+            Py_DECREF(lower);
+            Py_DECREF(upper);
+            return -1;
+        }
+        config.use_seed = 1;
+        config.seed = static_cast<unsigned int>(seed);
+    }
+
+    // With an objective, the initial population is evaluated while creating the optimizer.
+    Py_INCREF(objective);
+    Py_XSETREF(self->objective, objective);
+    self->vectorized = vectorized;
+    self->in_call = true;
+    self->opt = objective != Py_None ? spyopt_create_batch(&config, batchObjective, self)
+                                     : spyopt_create_ask_tell(&config);
+    self->in_call = false;
+    Py_DECREF(lower);
+    Py_DECREF(upper);
+    if (self->opt == nullptr)
+    {
+        raiseError();
+        return -1;
+    }
+    return 0;
+}
+
+/* Methods */
+
+PyObject *SpyOpt_optimize(SpyOptObject *self, PyObject *)
+{
+    if (!enterCall(self))
+    {
+        return nullptr;
+    }
+    const int status = spyopt_optimize(self->opt);
+    self->in_call = false;
+    if (status != SPYOPT_OK)
+    {
+        return raiseError();
+    }
+    Py_RETURN_NONE;
+}
+
+PyObject *SpyOpt_step(SpyOptObject *self, PyObject *args)
+{
+    Py_ssize_t num_steps = 1;
+    if (!PyArg_ParseTuple(args, "|n", &num_steps))
+    {
+        return nullptr;
+    }
+    if (num_steps < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "num_steps should not be negative");
+        return nullptr;
+    }
+    if (!enterCall(self))
+    {
+        return nullptr;
+    }
+    size_t num_done = 0;
+    const int status = spyopt_step(self->opt, num_steps, &num_done);
+    self->in_call = false;
+    if (status != SPYOPT_OK)
+    {
+        return raiseError();
+    }
+    return PyLong_FromSize_t(num_done);
+}
+
+PyObject *SpyOpt_reset(SpyOptObject *self, PyObject *)
+{
+    if (!enterCall(self))
+    {
+        return nullptr;
+    }
+    const int status = spyopt_reset(self->opt);
+    self->in_call = false;
+    if (status != SPYOPT_OK)
+    {
+        return raiseError();
+    }
+    Py_RETURN_NONE;
+}
+
+PyObject *SpyOpt_ask(SpyOptObject *self, PyObject *)
+{
+    if (!enterCall(self))
+    {
+        return nullptr;
+    }
+    size_t num_candidates = 0;
+    const double *candidates = spyopt_ask(self->opt, &num_candidates);
+    self->in_call = false;
+    if (candidates == nullptr)
+    {
+        return raiseError();
+    }
+    npy_intp dims[2] = {static_cast<npy_intp>(num_candidates), static_cast<npy_intp>(spyopt_input_dim(self->opt))};
+    return makeView(reinterpret_cast<PyObject *>(self), candidates, 2, dims);
+}
+
+PyObject *SpyOpt_tell(SpyOptObject *self, PyObject *fitness_obj)
+{
+    PyObject *fitness = PyArray_FROMANY(fitness_obj, NPY_DOUBLE, 0, 1, NPY_ARRAY_IN_ARRAY);
+    if (fitness == nullptr)
+    {
+        return nullptr;
+    }
+    if (!enterCall(self))
+    {
+        Py_DECREF(fitness);
+        return nullptr;
+    }
+    const int status = spyopt_tell(self->opt,
+                                   static_cast<const double *>(PyArray_DATA(reinterpret_cast<PyArrayObject *>(fitness))),
+                                   PyArray_SIZE(reinterpret_cast<PyArrayObject *>(fitness)));
+    self->in_call = false;
+    Py_DECREF(fitness);
+    if (status != SPYOPT_OK)
+    {
+        return raiseError();
+    }
+    Py_RETURN_NONE;
+}
+
+PyMethodDef SpyOpt_methods[] = {
+    {"optimize", reinterpret_cast<PyCFunction>(SpyOpt_optimize), METH_NOARGS,
+     "Run the remaining iterations."},
+    {"step", reinterpret_cast<PyCFunction>(SpyOpt_step), METH_VARARGS,
+     "step(num_steps=1) -> int\n\nRun up to num_steps iterations and return the number actually run."},
+    {"ask", reinterpret_cast<PyCFunction>(SpyOpt_ask), METH_NOARGS,
+     "ask() -> ndarray\n\nRead-only (num_agents, dim) view of the candidates to evaluate, in rank order.\n"
+     "The buffer is reused by the next ask()."},
+    {"tell", reinterpret_cast<PyCFunction>(SpyOpt_tell), METH_O,
+     "tell(fitness)\n\nGive one fitness value per candidate of the last ask() and advance the iteration.\n"
+     "NaN marks a failed evaluation and is stored as +inf."},
+    {"reset", reinterpret_cast<PyCFunction>(SpyOpt_reset), METH_NOARGS,
+     "Restart from a new random population. Previously returned history views then show the new run."},
+    {nullptr, nullptr, 0, nullptr}};
+
+/* Properties */
+
+PyObject *SpyOpt_get_best(SpyOptObject *self, void *)
+{
+    if (self->opt == nullptr)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "SpyOpt is not initialized");
+        return nullptr;
+    }
+    npy_intp dims[1] = {static_cast<npy_intp>(spyopt_input_dim(self->opt))};
+    PyObject *position = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if (position == nullptr)
+    {
+        return nullptr;
+    }
+    double fitness;
+    if (spyopt_get_best(self->opt, &fitness,
+                        static_cast<double *>(PyArray_DATA(reinterpret_cast<PyArrayObject *>(position)))) != SPYOPT_OK)
+    {
+        Py_DECREF(position);
+        return raiseError();
+    }
+    return Py_BuildValue("(dN)", fitness, position);
+}
+
+PyObject *SpyOpt_get_num_evaluations(SpyOptObject *self, void *)
+{
+    return PyLong_FromSize_t(spyopt_num_evaluations(self->opt));
+}
+
+PyObject *SpyOpt_get_finished(SpyOptObject *self, void *)
+{
+    return PyBool_FromLong(spyopt_finished(self->opt));
+}
+
+PyObject *SpyOpt_get_iteration(SpyOptObject *self, void *)
+{
+    return PyLong_FromSize_t(spyopt_iteration(self->opt));
+}
+
+// 'which': 0 best fitness, 1 best position, 2 agents fitness, 3 agents position
+PyObject *SpyOpt_get_history(SpyOptObject *self, void *closure)
+{
+    if (self->opt == nullptr)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "SpyOpt is not initialized");
+        return nullptr;
+    }
+    const auto which = reinterpret_cast<intptr_t>(closure);
+    const npy_intp dim = spyopt_input_dim(self->opt);
+    const npy_intp num_agents = spyopt_num_agents(self->opt);
+    size_t num_rows = 0;
+    switch (which)
+    {
+        case 0:
+        {
+            const double *data = spyopt_best_fitness_history(self->opt, &num_rows);
+            npy_intp dims[1] = {static_cast<npy_intp>(num_rows)};
+            return makeView(reinterpret_cast<PyObject *>(self), data, 1, dims);
+        }
+        case 1:
+        {
+            const double *data = spyopt_best_position_history(self->opt, &num_rows);
+            npy_intp dims[2] = {static_cast<npy_intp>(num_rows), dim};
+            return makeView(reinterpret_cast<PyObject *>(self), data, 2, dims);
+        }
+        case 2:
+        {
+            const double *data = spyopt_agents_fitness_history(self->opt, &num_rows);
+            npy_intp dims[2] = {static_cast<npy_intp>(num_rows), num_agents};
+            return makeView(reinterpret_cast<PyObject *>(self), data, 2, dims);
+        }
+        default:
+        {
+            const double *data = spyopt_agents_position_history(self->opt, &num_rows);
+            npy_intp dims[3] = {static_cast<npy_intp>(num_rows), num_agents, dim};
+            return makeView(reinterpret_cast<PyObject *>(self), data, 3, dims);
+        }
+    }
+}
+
+PyGetSetDef SpyOpt_getset[] = {
+    {"best", reinterpret_cast<getter>(SpyOpt_get_best), nullptr,
+     "(fitness, position) of the best agent.", nullptr},
+    {"num_evaluations", reinterpret_cast<getter>(SpyOpt_get_num_evaluations), nullptr,
+     "Number of objective evaluations, including refinement.", nullptr},
+    {"finished", reinterpret_cast<getter>(SpyOpt_get_finished), nullptr,
+     "True if no iteration is left or the evaluation budget is exhausted.", nullptr},
+    {"iteration", reinterpret_cast<getter>(SpyOpt_get_iteration), nullptr,
+     "Index of the next iteration.", nullptr},
+    {"best_fitness_history", reinterpret_cast<getter>(SpyOpt_get_history), nullptr,
+     "Read-only view, shape (iterations,).", reinterpret_cast<void *>(0)},
+    {"best_position_history", reinterpret_cast<getter>(SpyOpt_get_history), nullptr,
+     "Read-only view, shape (iterations, dim).", reinterpret_cast<void *>(1)},
+    {"agents_fitness_history", reinterpret_cast<getter>(SpyOpt_get_history), nullptr,
+     "Read-only view, shape (iterations, num_agents), indexed by agent ID.", reinterpret_cast<void *>(2)},
+    {"agents_position_history", reinterpret_cast<getter>(SpyOpt_get_history), nullptr,
+     "Read-only view, shape (iterations, num_agents, dim), indexed by agent ID.", reinterpret_cast<void *>(3)},
+    {nullptr, nullptr, nullptr, nullptr, nullptr}};
+
+PyTypeObject SpyOptType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+
+PyModuleDef spyopt_module = {PyModuleDef_HEAD_INIT, "spyopt", "Python bindings of SpyOpt.", -1};
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_spyopt(void)
+{
+    import_array();
+
+    SpyOptType.tp_name = "spyopt.SpyOpt";
+    SpyOptType.tp_doc = PyDoc_STR(
+        "SpyOpt(objective, lower_bounds, upper_bounds, *, num_agents=100, num_high_rank=20, num_mid_rank=60,\n"
+        "       num_iterations=50, swing_factor=0.3, adaptive_control=False, refinement_method='None',\n"
+        "       refinement_interval=0, refinement_stall=5, num_refined_agents=1, refinement_evaluations=100,\n"
+        "       max_evaluations=0, seed=None, verbose=False, vectorized=True)\n\n"
+        "With vectorized=True, objective(X) receives a read-only (n, dim) view and returns n fitness values.\n"
+        "The view is only meaningful during the call. With vectorized=False, objective(x) is called per row.\n"
+        "With objective=None, drive the optimization with ask() and tell().");
+    SpyOptType.tp_basicsize = sizeof(SpyOptObject);
+    SpyOptType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC;
+    SpyOptType.tp_new = PyType_GenericNew;
+    SpyOptType.tp_init = reinterpret_cast<initproc>(SpyOpt_init);
+    SpyOptType.tp_dealloc = reinterpret_cast<destructor>(SpyOpt_dealloc);
+    SpyOptType.tp_traverse = reinterpret_cast<traverseproc>(SpyOpt_traverse);
+    SpyOptType.tp_clear = reinterpret_cast<inquiry>(SpyOpt_clear);
+    SpyOptType.tp_methods = SpyOpt_methods;
+    SpyOptType.tp_getset = SpyOpt_getset;
+    if (PyType_Ready(&SpyOptType) < 0)
+    {
+        return nullptr;
+    }
+
+    PyObject *module = PyModule_Create(&spyopt_module);
+    if (module == nullptr)
+    {
+        return nullptr;
+    }
+    Py_INCREF(&SpyOptType);
+    if (PyModule_AddObject(module, "SpyOpt", reinterpret_cast<PyObject *>(&SpyOptType)) < 0)
+    {
+        Py_DECREF(&SpyOptType);
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
@@ -5,72 +5,79 @@ namespace spy_opt
 
 Agent::Agent(size_t id,
              const std::vector<double> init_pos,
-             std::function<double(const std::vector<double>&)> objective_func,
              const std::vector<double> lower_bounds,
              const std::vector<double> upper_bounds,
-             size_t max_iteration,
              const std::mt19937 &rand_engine)
     : id(id),
+      fitness(std::numeric_limits<double>::infinity()),
       position_(init_pos),
-      objective_func_(objective_func),
+      prev_position_(init_pos),
       lower_bounds_(lower_bounds),
       upper_bounds_(upper_bounds),
-      rand_engine_(rand_engine),
-      fitness(objective_func(init_pos))
+      rand_engine_(rand_engine)
 {
-    pos_history.reserve(max_iteration);
-    pos_history.emplace_back(position_);
-    fitness_history.reserve(max_iteration);
-    fitness_history.emplace_back(fitness);
 }
 
 void Agent::reset(const std::vector<double> &init_pos)
 {
     position_ = init_pos;
-    fitness = objective_func_(init_pos);
-    pos_history.clear();
-    pos_history.emplace_back(position_);
-    fitness_history.clear();
-    fitness_history.emplace_back(fitness);
+    prev_position_ = init_pos;
+    fitness = std::numeric_limits<double>::infinity();
 }
 
 void Agent::swingMove(size_t time, double swing_factor)
 {
-    static std::uniform_real_distribution<> uniform_dist(-1, 1);
+    this->swingMove(swing_factor / time);
+}
+
+void Agent::swingMove(double step)
+{
+    std::uniform_real_distribution<> uniform_dist(-1, 1);
+    prev_position_ = position_;
     for(auto &pos : position_) {
-        pos += uniform_dist(rand_engine_) * (swing_factor / time);
+        pos += uniform_dist(rand_engine_) * step;
     }
     this->clipPosition();
-    fitness = objective_func_(position_);
-    pos_history.emplace_back(position_);
-    fitness_history.emplace_back(fitness);
 }
 
-void Agent::moveToward(const Agent &better_agent)
+void Agent::moveToward(const std::vector<double> &better_pos)
 {
-    static std::uniform_real_distribution<> uniform_dist(-1, 1);
+    std::uniform_real_distribution<> uniform_dist(-1, 1);
+    prev_position_ = position_;
     for(size_t i = 0, n = position_.size(); i < n; ++i)
     {
-        position_[i] += uniform_dist(rand_engine_) * (better_agent.getPosition()[i] - position_[i]);
+        position_[i] += uniform_dist(rand_engine_) * (better_pos[i] - position_[i]);
     }
     this->clipPosition();
-    fitness = objective_func_(position_);
-    pos_history.emplace_back(position_);
-    fitness_history.emplace_back(fitness);
 }
 
 void Agent::randomSearch()
 {
-    static std::uniform_real_distribution<> uniform_dist(0, 1);
+    std::uniform_real_distribution<> uniform_dist(0, 1);
+    prev_position_ = position_;
     for (size_t i = 0, n = position_.size(); i < n; ++i)
     {
         const double range = upper_bounds_[i] - lower_bounds_[i];
         position_[i] = lower_bounds_[i] + range * uniform_dist(rand_engine_);
     }
     this->clipPosition();
-    fitness = objective_func_(position_);
-    pos_history.emplace_back(position_);
-    fitness_history.emplace_back(fitness);
+}
+
+void Agent::evaluated(double new_fitness, bool greedy)
+{
+    if (greedy && !(new_fitness < fitness))
+    {
+        position_ = prev_position_;
+        return;
+    }
+    fitness = new_fitness;
+}
+
+void Agent::relocate(const std::vector<double> &pos, double new_fitness)
+{
+    position_ = pos;
+    this->clipPosition();
+    fitness = new_fitness;
 }
 
 const std::vector<double>& Agent::getPosition() const
@@ -78,6 +85,11 @@ const std::vector<double>& Agent::getPosition() const
     return position_;
 }
 
+const std::vector<double>& Agent::getPreviousPosition() const
+{
+    return prev_position_;
+}
+
 void Agent::clipPosition()
 {
     for (size_t i = 0, n = position_.size(); i < n; ++i)
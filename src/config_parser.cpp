@@ -30,6 +30,42 @@ namespace spy_opt
             return false;
         }
         config.input_dim = config.lower_bounds.size();
+
+        // Optional parameters
+        if (node["adaptive_control"] &&
+            !safeLoadScalar(node, "adaptive_control", config.adaptive_control))
+        {
+            return false;
+        }
+        if ((node["refinement_method"] &&
+             !safeLoadScalar(node, "refinement_method", config.refinement_method)) ||
+            (node["refinement_interval"] &&
+             !safeLoadScalar(node, "refinement_interval", config.refinement_interval)) ||
+            (node["refinement_stall"] &&
+             !safeLoadScalar(node, "refinement_stall", config.refinement_stall)) ||
+            (node["num_refined_agents"] &&
+             !safeLoadScalar(node, "num_refined_agents", config.num_refined_agents)) ||
+            (node["refinement_evaluations"] &&
+             !safeLoadScalar(node, "refinement_evaluations", config.refinement_evaluations)) ||
+            (node["max_evaluations"] &&
+             !safeLoadScalar(node, "max_evaluations", config.max_evaluations)))
+        {
+            return false;
+        }
+        if (node["seed"])
+        {
+            unsigned int seed;
+            if (!safeLoadScalar(node, "seed", seed))
+            {
+                return false;
+            }
+            config.seed = seed;
+        }
+        if (node["verbose"] &&
+            !safeLoadScalar(node, "verbose", config.verbose))
+        {
+            return false;
+        }
     }
     catch (const YAML::Exception &e)
     {
@@ -39,4 +75,80 @@ namespace spy_opt
     return true;
 }
 
+[[nodiscard]] bool parseSweepConfig(const std::string &config_path, SweepConfig &sweep_config)
+{
+    if (!std::filesystem::exists(config_path))
+    {
+        std::cerr << "[Error] Sweep config file does not exist: " << config_path << std::endl;
+        return false;
+    }
+    try
+    {
+        YAML::Node node = YAML::LoadFile(config_path);
+
+        if (!safeLoadScalar(node, "base_config", sweep_config.base_config_path) ||
+            !safeLoadScalar(node, "num_seeds", sweep_config.num_seeds) ||
+            !safeLoadScalar(node, "output", sweep_config.output_path))
+        {
+            return false;
+        }
+
+        // Optional parameters
+        if ((node["seed"] && !safeLoadScalar(node, "seed", sweep_config.seed)) ||
+            (node["num_threads"] && !safeLoadScalar(node, "num_threads", sweep_config.num_threads)) ||
+            (node["prune_after"] && !safeLoadScalar(node, "prune_after", sweep_config.prune_after)) ||
+            (node["num_random_samples"] &&
+             !safeLoadScalar(node, "num_random_samples", sweep_config.num_random_samples)))
+        {
+            return false;
+        }
+
+        if (node["grid"])
+        {
+            if (!node["grid"].IsMap())
+            {
+                std::cerr << "[Error] 'grid' should be a map of parameter sequences." << std::endl;
+                return false;
+            }
+            for (const auto &item : node["grid"])
+            {
+                const auto name = item.first.as<std::string>();
+                if (!safeLoadVector(node["grid"], name, sweep_config.grid[name]))
+                {
+                    return false;
+                }
+            }
+        }
+        if (node["random"])
+        {
+            if (!node["random"].IsMap())
+            {
+                std::cerr << "[Error] 'random' should be a map of [min, max] ranges." << std::endl;
+                return false;
+            }
+            for (const auto &item : node["random"])
+            {
+                const auto name = item.first.as<std::string>();
+                std::vector<double> range;
+                if (!safeLoadVector(node["random"], name, range))
+                {
+                    return false;
+                }
+                if (range.size() != 2)
+                {
+                    std::cerr << "[Error] Random range '" << name << "' should be [min, max]." << std::endl;
+                    return false;
+                }
+                sweep_config.random_ranges[name] = {range[0], range[1]};
+            }
+        }
+    }
+    catch (const YAML::Exception &e)
+    {
+        std::cerr << "[Error] Failed to parse the sweep config file: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
 } // namespace spy_opt
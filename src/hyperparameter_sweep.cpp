@@ -0,0 +1,58 @@
+#include <iostream>
+
+#include "SpyOpt/config_parser.h"
+#include "SpyOpt/spy_opt.h"
+#include "SpyOpt/sweep.h"
+#include "SpyOpt/objective_functions.h"
+
+using namespace spy_opt;
+
+int main(int argc, char **argv)
+{
+    const std::string sweep_config_path = argc > 1 ? argv[1] : "../resources/sweep.yaml";
+
+    SweepConfig sweep_config;
+    if (!parseSweepConfig(sweep_config_path, sweep_config))
+    {
+        std::cerr << "[Error] Failed to parse sweep config!" << std::endl;
+        return -1;
+    }
+    std::cout << sweep_config << std::endl;
+
+    Config config;
+    if (!parseConfig(sweep_config.base_config_path, config))
+    {
+        std::cerr << "[Error] Failed to parse config!" << std::endl;
+        return -1;
+    }
+
+    // The objective function is resolved once and shared by every run.
+    std::function<double(const std::vector<double>&)> objective_function;
+    if (config.objective_func_name == "Booth")
+    {
+        std::cout << "Using Booth function." << std::endl;
+        objective_function = booth_func;
+    }
+    else if (config.objective_func_name == "Eggholder")
+    {
+        std::cout << "Using Eggholder function." << std::endl;
+        objective_function = eggholder_func;
+    }
+    else if (config.objective_func_name == "Ackley")
+    {
+        std::cout << "Using Ackley function." << std::endl;
+        objective_function = ackley_function;
+    }
+    else
+    {
+        std::cerr << "[Error] Invalid objective function name." << std::endl;
+        return -1;
+    }
+
+    HyperparameterSweep sweep(config, sweep_config, objective_function);
+    sweep.run();
+    sweep.printBestConfig();
+    sweep.dumpResults(sweep_config.output_path);
+
+    return 0;
+}
@@ -0,0 +1,415 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "SpyOpt/local_search.h"
+
+namespace spy_opt
+{
+
+LocalSearchMethod toLocalSearchMethod(const std::string &name)
+{
+    if (name == "None")
+    {
+        return LocalSearchMethod::None;
+    }
+    if (name == "NelderMead")
+    {
+        return LocalSearchMethod::NelderMead;
+    }
+    if (name == "PatternSearch")
+    {
+        return LocalSearchMethod::PatternSearch;
+    }
+    if (name == "QuasiNewton")
+    {
+        return LocalSearchMethod::QuasiNewton;
+    }
+    throw std::runtime_error(
+        "[Error] 'refinement_method' should be one of None, NelderMead, PatternSearch and QuasiNewton.");
+}
+
+/* Public methods */
+
+LocalSearch::LocalSearch(LocalSearchMethod method,
+                         std::function<double(const std::vector<double>&)> objective_func,
+                         const std::vector<double> &lower_bounds,
+                         const std::vector<double> &upper_bounds)
+    : method_(method),
+      // NaN is treated as the worst fitness, as in SpyOpt::tell()
+      objective_func_([objective_func](const std::vector<double> &pos) -> double
+      {
+          const double fitness = objective_func(pos);
+          return std::isnan(fitness) ? std::numeric_limits<double>::infinity() : fitness;
+      }),
+      lower_bounds_(lower_bounds),
+      upper_bounds_(upper_bounds)
+{
+}
+
+LocalSearchResult LocalSearch::refine(const std::vector<double> &init_pos,
+                                      double init_fitness,
+                                      double initial_step,
+                                      size_t max_evaluations,
+                                      size_t &num_evaluations) const
+{
+    switch (method_)
+    {
+        case LocalSearchMethod::NelderMead:
+            return this->nelderMead(init_pos, init_fitness, initial_step, max_evaluations, num_evaluations);
+        case LocalSearchMethod::PatternSearch:
+            return this->patternSearch(init_pos, init_fitness, initial_step, max_evaluations, num_evaluations);
+        case LocalSearchMethod::QuasiNewton:
+            return this->quasiNewton(init_pos, init_fitness, initial_step, max_evaluations, num_evaluations);
+        case LocalSearchMethod::None:
+        default:
+            return {init_pos, init_fitness};
+    }
+}
+
+LocalSearchMethod LocalSearch::getMethod() const
+{
+    return method_;
+}
+
+/* Private methods */
+
+LocalSearchResult LocalSearch::nelderMead(const std::vector<double> &init_pos, double init_fitness,
+                                          double initial_step, size_t max_evaluations,
+                                          size_t &num_evaluations) const
+{
+    const size_t first_evaluation = num_evaluations;
+    const size_t max_total = num_evaluations + max_evaluations;
+    const size_t n = init_pos.size();
+    auto evaluate = [&](std::vector<double> &pos) -> double
+    {
+        this->clipPosition(pos);
+        ++num_evaluations;
+        return objective_func_(pos);
+    };
+
+    // Initial simplex: init_pos and one step along each axis (inward at the upper bound)
+    std::vector<std::vector<double>> simplex(n + 1, init_pos);
+    std::vector<double> values(n + 1, init_fitness);
+    for (size_t i = 0; i < n && num_evaluations < max_total; ++i)
+    {
+        const bool inward = init_pos[i] + initial_step > upper_bounds_[i];
+        simplex[i + 1][i] += inward ? -initial_step : initial_step;
+        values[i + 1] = evaluate(simplex[i + 1]);
+    }
+    if (num_evaluations - first_evaluation < n)
+    {
+        // Not enough budget for a full simplex
+        const size_t best = std::min_element(values.begin(), values.end()) - values.begin();
+        return {simplex[best], values[best]};
+    }
+
+    std::vector<size_t> order(n + 1);
+    std::vector<double> centroid(n), reflected(n), expanded(n), contracted(n);
+    while (num_evaluations < max_total)
+    {
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) { return values[lhs] < values[rhs]; });
+        const size_t best = order.front(), worst = order.back(), second_worst = order[n - 1];
+
+        const double spread = values[worst] - values[best];
+        if (spread <= std::numeric_limits<double>::epsilon() * (std::abs(values[best]) + 1.))
+        {
+            break;
+        }
+
+        std::fill(centroid.begin(), centroid.end(), 0.);
+        for (size_t k = 0; k < n; ++k)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                centroid[i] += simplex[order[k]][i] / n;
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            reflected[i] = centroid[i] + (centroid[i] - simplex[worst][i]);
+        }
+        const double f_reflected = evaluate(reflected);
+
+        if (f_reflected < values[best])
+        {
+            if (num_evaluations >= max_total)
+            {
+                simplex[worst] = reflected;
+                values[worst] = f_reflected;
+                break;
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                expanded[i] = centroid[i] + 2. * (centroid[i] - simplex[worst][i]);
+            }
+            const double f_expanded = evaluate(expanded);
+            if (f_expanded < f_reflected)
+            {
+                simplex[worst] = expanded;
+                values[worst] = f_expanded;
+            }
+            else
+            {
+                simplex[worst] = reflected;
+                values[worst] = f_reflected;
+            }
+            continue;
+        }
+        if (f_reflected < values[second_worst])
+        {
+            simplex[worst] = reflected;
+            values[worst] = f_reflected;
+            continue;
+        }
+        if (num_evaluations >= max_total)
+        {
+            break;
+        }
+
+        // Outside contraction if the reflected point is better than the worst, inside otherwise
+        const bool outside = f_reflected < values[worst];
+        const std::vector<double> &toward = outside ? reflected : simplex[worst];
+        for (size_t i = 0; i < n; ++i)
+        {
+            contracted[i] = centroid[i] + 0.5 * (toward[i] - centroid[i]);
+        }
+        const double f_contracted = evaluate(contracted);
+        if (f_contracted < std::min(f_reflected, values[worst]))
+        {
+            simplex[worst] = contracted;
+            values[worst] = f_contracted;
+            continue;
+        }
+
+        // Shrink toward the best vertex
+        for (size_t k = 1; k <= n && num_evaluations < max_total; ++k)
+        {
+            auto &vertex = simplex[order[k]];
+            for (size_t i = 0; i < n; ++i)
+            {
+                vertex[i] = simplex[best][i] + 0.5 * (vertex[i] - simplex[best][i]);
+            }
+            values[order[k]] = evaluate(vertex);
+        }
+    }
+
+    const size_t best = std::min_element(values.begin(), values.end()) - values.begin();
+    if (values[best] < init_fitness)
+    {
+        return {simplex[best], values[best]};
+    }
+    return {init_pos, init_fitness};
+}
+
+LocalSearchResult LocalSearch::patternSearch(const std::vector<double> &init_pos, double init_fitness,
+                                             double initial_step, size_t max_evaluations,
+                                             size_t &num_evaluations) const
+{
+    // Compass search: poll +/- step along each axis, halve the step when no poll improves.
+    const size_t max_total = num_evaluations + max_evaluations;
+    std::vector<double> pos = init_pos;
+    double fitness = init_fitness;
+    double step = initial_step;
+
+    double scale = 1.;
+    for (const auto &x : pos)
+    {
+        scale = std::max(scale, std::abs(x));
+    }
+    const double min_step = std::numeric_limits<double>::epsilon() * scale;
+
+    std::vector<double> trial;
+    while (num_evaluations < max_total && step > min_step)
+    {
+        bool improved = false;
+        for (size_t i = 0, n = pos.size(); i < n && !improved && num_evaluations < max_total; ++i)
+        {
+            for (const double direction : {1., -1.})
+            {
+                if (num_evaluations >= max_total)
+                {
+                    break;
+                }
+                trial = pos;
+                trial[i] += direction * step;
+                this->clipPosition(trial);
+                if (trial[i] == pos[i])
+                {
+                    continue;
+                }
+                ++num_evaluations;
+                const double trial_fitness = objective_func_(trial);
+                if (trial_fitness < fitness)
+                {
+                    pos = trial;
+                    fitness = trial_fitness;
+                    improved = true;
+                    break;
+                }
+            }
+        }
+        if (!improved)
+        {
+            step *= 0.5;
+        }
+    }
+    return {pos, fitness};
+}
+
+LocalSearchResult LocalSearch::quasiNewton(const std::vector<double> &init_pos, double init_fitness,
+                                           double initial_step, size_t max_evaluations,
+                                           size_t &num_evaluations) const
+{
+    const size_t max_total = num_evaluations + max_evaluations;
+    const size_t n = init_pos.size();
+    const double sqrt_eps = std::sqrt(std::numeric_limits<double>::epsilon());
+
+    auto dot = [](const std::vector<double> &a, const std::vector<double> &b) -> double
+    {
+        return std::inner_product(a.begin(), a.end(), b.begin(), 0.);
+    };
+    // Forward differences, backward at the upper bound. Costs n evaluations.
+    auto gradient = [&](const std::vector<double> &pos, double fitness) -> std::vector<double>
+    {
+        std::vector<double> grad(n), probe = pos;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double h = sqrt_eps * std::max(1., std::abs(pos[i]));
+            if (pos[i] + h > upper_bounds_[i])
+            {
+                h = -h;
+            }
+            probe[i] = pos[i] + h;
+            ++num_evaluations;
+            grad[i] = (objective_func_(probe) - fitness) / h;
+            probe[i] = pos[i];
+        }
+        return grad;
+    };
+
+    std::vector<double> pos = init_pos;
+    double fitness = init_fitness;
+    if (max_evaluations < n + 1)
+    {
+        return {pos, fitness};
+    }
+    std::vector<double> grad = gradient(pos, fitness);
+
+    // Inverse Hessian approximation, scaled so that the first step has length initial_step
+    std::vector<std::vector<double>> inv_hessian(n, std::vector<double>(n, 0.));
+    auto reset_inv_hessian = [&]()
+    {
+        const double grad_norm = std::sqrt(dot(grad, grad));
+        const double scale = grad_norm > 0. ? initial_step / grad_norm : initial_step;
+        for (size_t i = 0; i < n; ++i)
+        {
+            std::fill(inv_hessian[i].begin(), inv_hessian[i].end(), 0.);
+            inv_hessian[i][i] = scale;
+        }
+    };
+    reset_inv_hessian();
+
+    std::vector<double> direction(n), trial(n), s(n), y(n), hy(n);
+    while (num_evaluations < max_total)
+    {
+        if (std::sqrt(dot(grad, grad)) <= sqrt_eps * (std::abs(fitness) + 1.) * 1e-3)
+        {
+            break;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            direction[i] = -dot(inv_hessian[i], grad);
+        }
+        double slope = dot(grad, direction);
+        if (slope >= 0.)
+        {
+            reset_inv_hessian();
+            for (size_t i = 0; i < n; ++i)
+            {
+                direction[i] = -inv_hessian[i][i] * grad[i];
+            }
+            slope = dot(grad, direction);
+        }
+
+        // Backtracking line search (Armijo condition) on the clipped path
+        double alpha = 1.;
+        double trial_fitness = fitness;
+        bool accepted = false;
+        while (num_evaluations < max_total)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                trial[i] = pos[i] + alpha * direction[i];
+            }
+            this->clipPosition(trial);
+            ++num_evaluations;
+            trial_fitness = objective_func_(trial);
+            if (trial_fitness <= fitness + 1e-4 * alpha * slope)
+            {
+                accepted = true;
+                break;
+            }
+            alpha *= 0.5;
+            if (alpha < sqrt_eps)
+            {
+                break;
+            }
+        }
+        if (!accepted)
+        {
+            break;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            s[i] = trial[i] - pos[i];
+        }
+        pos = trial;
+        fitness = trial_fitness;
+        if (num_evaluations + n > max_total)
+        {
+            break;
+        }
+        const std::vector<double> new_grad = gradient(pos, fitness);
+        for (size_t i = 0; i < n; ++i)
+        {
+            y[i] = new_grad[i] - grad[i];
+        }
+        grad = new_grad;
+
+        // BFGS update of the inverse Hessian, skipped when the curvature condition fails
+        const double sy = dot(s, y);
+        if (sy <= std::numeric_limits<double>::epsilon() * std::sqrt(dot(s, s) * dot(y, y)))
+        {
+            continue;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            hy[i] = dot(inv_hessian[i], y);
+        }
+        const double yhy = dot(y, hy);
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                inv_hessian[i][j] += (sy + yhy) * s[i] * s[j] / (sy * sy)
+                                     - (hy[i] * s[j] + s[i] * hy[j]) / sy;
+            }
+        }
+    }
+    return {pos, fitness};
+}
+
+void LocalSearch::clipPosition(std::vector<double> &pos) const
+{
+    for (size_t i = 0, n = pos.size(); i < n; ++i)
+    {
+        pos[i] = std::clamp(pos[i], lower_bounds_[i], upper_bounds_[i]);
+    }
+}
+
+} // namespace spy_opt
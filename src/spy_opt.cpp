@@ -1,7 +1,10 @@
 #include <algorithm>
+#include <cmath>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <iomanip> // for std::setw
+#include <limits>
 #include <yaml-cpp/yaml.h>
 
 #include "SpyOpt/spy_opt.h"
@@ -30,6 +33,23 @@ std::ostream& operator<<(std::ostream &os, const Config &config)
     os << "\n  num_mid_rank: " << config.num_mid_rank;
     os << "\n  num_iterations: " << config.num_iterations;
     os << "\n  swing_factor: " << config.swing_factor;
+    os << "\n  adaptive_control: " << std::boolalpha << config.adaptive_control << std::noboolalpha;
+    if (config.refinement_method != "None")
+    {
+        os << "\n  refinement_method: " << config.refinement_method;
+        os << "\n  refinement_interval: " << config.refinement_interval;
+        os << "\n  refinement_stall: " << config.refinement_stall;
+        os << "\n  num_refined_agents: " << config.num_refined_agents;
+        os << "\n  refinement_evaluations: " << config.refinement_evaluations;
+    }
+    if (config.max_evaluations > 0)
+    {
+        os << "\n  max_evaluations: " << config.max_evaluations;
+    }
+    if (config.seed)
+    {
+        os << "\n  seed: " << *config.seed;
+    }
     os << "\n  input_dim: " << config.input_dim;
     os << "\n  lower_bounds: ";
     print_vec(config.lower_bounds);
@@ -42,52 +62,297 @@ std::ostream& operator<<(std::ostream &os, const Config &config)
 
 SpyOpt::SpyOpt(const Config &config,
                std::function<double(const std::vector<double>&)> objective_func)
-               : config_(config), uniform_dist_(0., 1.)
+               : SpyOpt(config,
+                        objective_func,
+                        [objective_func](const double *positions, size_t num_positions, size_t dim, double *fitness)
+                        {
+                            std::vector<double> pos(dim);
+                            for (size_t i = 0; i < num_positions; ++i)
+                            {
+                                std::copy(positions + i * dim, positions + (i + 1) * dim, pos.begin());
+                                fitness[i] = objective_func(pos);
+                            }
+                        })
 {
-    this->validateConfig();
-    std::random_device rd;
-    rand_engine_.seed(rd());
-    this->generateAgents(objective_func);
+}
 
-    best_fitness_history_.reserve(config_.num_iterations);
-    best_pos_history_.reserve(config_.num_iterations);
-    this->updateHistory();
+SpyOpt::SpyOpt(const Config &config,
+               BatchObjectiveFunction batch_objective_func)
+               : SpyOpt(config,
+                        [batch_objective_func](const std::vector<double> &pos) -> double
+                        {
+                            double fitness;
+                            batch_objective_func(pos.data(), 1, pos.size(), &fitness);
+                            return fitness;
+                        },
+                        batch_objective_func)
+{
+}
+
+SpyOpt::SpyOpt(const Config &config)
+               : SpyOpt(config, nullptr, nullptr)
+{
+}
+
+SpyOpt::SpyOpt(const Config &config,
+               std::function<double(const std::vector<double>&)> objective_func,
+               BatchObjectiveFunction batch_objective_func)
+               : uniform_dist_(0., 1.),
+                 config_(config),
+                 objective_func_(objective_func),
+                 batch_objective_func_(batch_objective_func),
+                 local_search_(toLocalSearchMethod(config.refinement_method),
+                               objective_func,
+                               config.lower_bounds,
+                               config.upper_bounds)
+{
+    validateConfig(config_);
+    if (local_search_.getMethod() != LocalSearchMethod::None && !objective_func_)
+    {
+        throw std::runtime_error(
+            "[Error] 'refinement_method' needs an objective function and cannot be used with ask() and tell() only.");
+    }
+    if (config_.seed)
+    {
+        rand_engine_.seed(*config_.seed);
+    }
+    else
+    {
+        std::random_device rd;
+        rand_engine_.seed(rd());
+    }
+    this->initAdaptiveState();
+    candidates_.resize(config_.num_agents * config_.input_dim);
+    candidate_fitness_.resize(config_.num_agents);
+    refined_agents_.assign(config_.num_agents, false);
+    this->generateAgents();
+    this->reserveHistory();
+
+    // Evaluate the initial population. Without an objective, it is the first ask().
+    if (batch_objective_func_)
+    {
+        this->step();
+    }
 }
 
 void SpyOpt::optimize()
 {
-    static const size_t num_high_mid = config_.num_high_rank + config_.num_mid_rank;
-    for(size_t t = 1; t < config_.num_iterations; ++t)
+    while (this->step())
     {
-        for(size_t i = 0; i < config_.num_high_rank; ++i)
+    }
+    if (iteration_ < config_.num_iterations && config_.verbose)
+    {
+        std::cout << std::endl << "Evaluation budget exhausted at iteration " << iteration_ << "." << std::endl;
+    }
+}
+
+bool SpyOpt::step()
+{
+    if (!batch_objective_func_)
+    {
+        throw std::runtime_error("[Error] step() and optimize() need an objective function. Use ask() and tell().");
+    }
+    if (this->isFinished())
+    {
+        return false;
+    }
+    const std::vector<double> &candidates = this->ask();
+    batch_objective_func_(candidates.data(), config_.num_agents, config_.input_dim, candidate_fitness_.data());
+    this->tell(candidate_fitness_.data(), config_.num_agents);
+    return true;
+}
+
+const std::vector<double>& SpyOpt::ask()
+{
+    if (asked_)
+    {
+        return candidates_;
+    }
+    if (this->isFinished())
+    {
+        throw std::runtime_error("[Error] No iteration is left to ask for.");
+    }
+    if (iteration_ > 0)
+    {
+        this->moveAgents();
+    }
+    const size_t dim = config_.input_dim;
+    for (size_t i = 0; i < config_.num_agents; ++i)
+    {
+        const auto &pos = agents_[i].getPosition();
+        std::copy(pos.begin(), pos.end(), candidates_.begin() + i * dim);
+    }
+    asked_ = true;
+    return candidates_;
+}
+
+void SpyOpt::tell(const double *fitness, size_t num_fitness)
+{
+    if (!asked_)
+    {
+        throw std::runtime_error("[Error] tell() should follow ask().");
+    }
+    if (num_fitness != config_.num_agents)
+    {
+        throw std::runtime_error("[Error] tell() expects one fitness value per candidate.");
+    }
+    // NaN (e.g. a failed evaluation) is stored as the worst fitness, so that the agents stay sortable
+    std::transform(fitness, fitness + num_fitness, candidate_fitness_.begin(), [](double f) -> double
+    {
+        return std::isnan(f) ? std::numeric_limits<double>::infinity() : f;
+    });
+    asked_ = false;
+    num_evaluations_ += num_fitness;
+
+    if (iteration_ == 0)
+    {
+        // Initial population
+        for (size_t i = 0; i < config_.num_agents; ++i)
         {
-            agents_[i].swingMove(t, config_.swing_factor);
+            agents_[i].evaluated(candidate_fitness_[i], false);
+        }
+        this->sortAgentsByFitness();
+        best_fitness_so_far_ = agents_.front().fitness;
+        this->updateHistory();
+        iteration_ = 1;
+        return;
+    }
+
+    const size_t t = iteration_;
+    std::array<size_t, 2> num_success = {0, 0};
+    for (size_t i = 0; i < config_.num_agents; ++i)
+    {
+        const bool high_rank = i < num_high_rank_;
+        if (i < num_high_rank_ + num_mid_rank_)
+        {
+            num_success[high_rank ? 0 : 1] += candidate_fitness_[i] < agents_[i].fitness;
         }
-        for(size_t i = config_.num_high_rank; i < num_high_mid; ++i)
+        if (!high_rank)
         {
-            std::uniform_int_distribution<> rand(0, i-1);
-            agents_[i].moveToward(agents_[rand(rand_engine_)]);
+            refined_agents_[agents_[i].id] = false;
         }
-        for(size_t i = num_high_mid; i < config_.num_agents; ++i)
+        agents_[i].evaluated(candidate_fitness_[i], high_rank && this->isSwingGreedy(agents_[i]));
+    }
+    this->sortAgentsByFitness();
+
+    if (config_.adaptive_control)
+    {
+        this->adaptParameters(num_success);
+    }
+    // Against the best fitness so far: the non-greedy swing can lose the best position and find it again
+    if (agents_.front().fitness < best_fitness_so_far_)
+    {
+        best_fitness_so_far_ = agents_.front().fitness;
+        num_stalled_iterations_ = 0;
+    }
+    else
+    {
+        ++num_stalled_iterations_;
+    }
+    // The population is already evaluated, so the iteration is completed even if the objective
+    // throws during refinement. The exception is rethrown afterwards.
+    std::exception_ptr refinement_error;
+    if (this->isRefinementDue(t))
+    {
+        try
         {
-            agents_[i].randomSearch();
+            this->refineEliteAgents(config_.adaptive_control ? swing_step_ : config_.swing_factor / t);
         }
-        this->sortAgentsByFitness();
+        catch (...)
+        {
+            refinement_error = std::current_exception();
+        }
+    }
+    if (config_.verbose)
+    {
         this->printProgress(t);
-        this->updateHistory();
+    }
+    this->updateHistory();
+    ++iteration_;
+    if (refinement_error)
+    {
+        std::rethrow_exception(refinement_error);
     }
 }
 
+void SpyOpt::tell(const std::vector<double> &fitness)
+{
+    this->tell(fitness.data(), fitness.size());
+}
+
+bool SpyOpt::isFinished() const
+{
+    return iteration_ >= config_.num_iterations || this->getRemainingEvaluations() < config_.num_agents;
+}
+
 void SpyOpt::reset()
 {
     last_printed_progress_ = 0;
-    best_fitness_history_.clear();
-    best_pos_history_.clear();
+    this->initAdaptiveState();
+    num_stalled_iterations_ = 0;
+    best_fitness_so_far_ = std::numeric_limits<double>::infinity();
+    refined_agents_.assign(config_.num_agents, false);
     for (auto &agent : agents_)
     {
         agent.reset(this->generateRandomPosition());
     }
-    this->updateHistory();
+    num_evaluations_ = 0;
+    iteration_ = 0;
+    asked_ = false;
+
+    best_fitness_history_.clear();
+    best_pos_history_.clear();
+    agents_fitness_history_.clear();
+    agents_pos_history_.clear();
+    if (batch_objective_func_)
+    {
+        this->step();
+    }
+}
+
+void SpyOpt::validateConfig(const Config &config)
+{
+    if (config.num_agents <= 0 || config.num_high_rank <= 0 || config.num_mid_rank <= 0)
+    {
+        throw std::runtime_error(
+            "[Error] 'num_agent', 'num_hign_rank' and 'num_mid_rank' should be greater than zero.");
+    }
+    if (config.num_agents <= config.num_high_rank + config.num_mid_rank)
+    {
+        throw std::runtime_error(
+            "[Error] 'num_agent' should be greater than (num_high_rank + num_mid_rank).");
+    }
+    if (config.num_refined_agents == 0 || config.num_refined_agents > config.num_agents)
+    {
+        throw std::runtime_error(
+            "[Error] 'num_refined_agents' should be in [1, num_agents].");
+    }
+    if (config.max_evaluations > 0 && config.max_evaluations < config.num_agents)
+    {
+        throw std::runtime_error(
+            "[Error] 'max_evaluations' should be at least 'num_agents'.");
+    }
+    if (config.num_iterations <= 0)
+    {
+        throw std::runtime_error(
+            "[Error] 'num_iteration' should be greater than zero.");
+    }
+    if (config.lower_bounds.size() != config.upper_bounds.size())
+    {
+        throw std::runtime_error(
+            "[Error] 'lower_bounds' and 'upper_bounds' should have the same length.");
+    }
+    // Throws for an unknown name
+    toLocalSearchMethod(config.refinement_method);
+    // Ensure upper_bound > lower_bound
+    for (size_t i = 0, n = config.lower_bounds.size(); i < n; ++i)
+    {
+        if (config.upper_bounds[i] <= config.lower_bounds[i])
+        {
+            throw std::runtime_error(
+                "[Error] 'upper_bounds' should be greater than 'lower_bounds'.");
+        }
+    }
 }
 
 std::pair<double, std::vector<double>> SpyOpt::getBestFitness() const
@@ -100,6 +365,41 @@ std::pair<double, std::vector<double>> SpyOpt::getBestFitness() const
     return {best_agent.fitness, best_agent.getPosition()};
 }
 
+size_t SpyOpt::getNumEvaluations() const
+{
+    return num_evaluations_;
+}
+
+size_t SpyOpt::getIteration() const
+{
+    return iteration_;
+}
+
+const Config& SpyOpt::getConfig() const
+{
+    return config_;
+}
+
+const std::vector<double>& SpyOpt::getBestFitnessHistory() const
+{
+    return best_fitness_history_;
+}
+
+const std::vector<double>& SpyOpt::getBestPositionHistory() const
+{
+    return best_pos_history_;
+}
+
+const std::vector<double>& SpyOpt::getAgentsFitnessHistory() const
+{
+    return agents_fitness_history_;
+}
+
+const std::vector<double>& SpyOpt::getAgentsPositionHistory() const
+{
+    return agents_pos_history_;
+}
+
 void SpyOpt::printAgents() const
 {
     for (const auto &agent : agents_)
@@ -113,7 +413,7 @@ void SpyOpt::printBestAgent() const
     std::cout << agents_.front() << std::endl;
 }
 
-void SpyOpt::dumpBestSolutionHistory(const std::string &filename)
+void SpyOpt::dumpBestSolutionHistory(const std::string &filename) const
 {
     std::ofstream file(filename);
 
@@ -125,20 +425,21 @@ void SpyOpt::dumpBestSolutionHistory(const std::string &filename)
     }
     file << "\n";
 
-    const size_t max_itr = best_pos_history_.size();
+    const size_t dim = config_.input_dim;
+    const size_t max_itr = best_fitness_history_.size();
     for (size_t itr = 0; itr < max_itr; ++itr)
     {
         file << itr;
         file << ", " << best_fitness_history_.at(itr);
-        for (const auto &pi : best_pos_history_.at(itr))
+        for (size_t i = 0; i < dim; ++i)
         {
-            file << ", " << pi;
+            file << ", " << best_pos_history_.at(itr * dim + i);
         }
         file << "\n";
     }
 }
 
-void SpyOpt::dumpAgentsHistory(const std::string &filename)
+void SpyOpt::dumpAgentsHistory(const std::string &filename) const
 {
     std::ofstream file(filename);
 
@@ -150,18 +451,20 @@ void SpyOpt::dumpAgentsHistory(const std::string &filename)
     }
     file << "\n";
 
-    this->sortAgentsByID();
-    const size_t max_itr = agents_.at(0).pos_history.size();
+    const size_t dim = config_.input_dim;
+    const size_t num_agents = config_.num_agents;
+    const size_t max_itr = agents_fitness_history_.size() / num_agents;
     for (size_t itr = 0; itr < max_itr; ++itr)
     {
-        for (const auto &agent : agents_)
+        for (size_t id = 0; id < num_agents; ++id)
         {
+            const size_t row = itr * num_agents + id;
             file << itr;
-            file << ", " << agent.id;
-            file << ", " << agent.fitness_history.at(itr);
-            for (const auto &pi : agent.pos_history.at(itr))
+            file << ", " << id;
+            file << ", " << agents_fitness_history_.at(row);
+            for (size_t i = 0; i < dim; ++i)
             {
-                file << ", " << pi;
+                file << ", " << agents_pos_history_.at(row * dim + i);
             }
             file << "\n";
         }
@@ -170,20 +473,47 @@ void SpyOpt::dumpAgentsHistory(const std::string &filename)
 
 /* Private methods */
 
-void SpyOpt::generateAgents(std::function<double(const std::vector<double>&)> objective_func)
+void SpyOpt::generateAgents()
 {
     agents_.reserve(config_.num_agents);
     for(size_t i = 0; i < config_.num_agents; ++i)
     {
         agents_.emplace_back(i,
                              this->generateRandomPosition(),
-                             objective_func,
                              config_.lower_bounds,
                              config_.upper_bounds,
-                             config_.num_iterations,
                              rand_engine_);
     }
-    this->sortAgentsByFitness();
+}
+
+void SpyOpt::moveAgents()
+{
+    const size_t t = iteration_;
+    const size_t num_high_mid = num_high_rank_ + num_mid_rank_;
+    for(size_t i = 0; i < num_high_rank_; ++i)
+    {
+        if (config_.adaptive_control)
+        {
+            agents_[i].swingMove(swing_step_);
+        }
+        else
+        {
+            agents_[i].swingMove(t, config_.swing_factor);
+        }
+    }
+    for(size_t i = num_high_rank_; i < num_high_mid; ++i)
+    {
+        std::uniform_int_distribution<> rand(0, i-1);
+        const size_t j = rand(rand_engine_);
+        // A greedy swing move is accepted only after the batch evaluation, so move toward
+        // the accepted position it reverts to rather than the trial one.
+        const bool greedy = j < num_high_rank_ && this->isSwingGreedy(agents_[j]);
+        agents_[i].moveToward(greedy ? agents_[j].getPreviousPosition() : agents_[j].getPosition());
+    }
+    for(size_t i = num_high_mid; i < config_.num_agents; ++i)
+    {
+        agents_[i].randomSearch();
+    }
 }
 
 std::vector<double> SpyOpt::generateRandomPosition()
@@ -207,49 +537,6 @@ void SpyOpt::sortAgentsByFitness()
               });
 }
 
-void SpyOpt::sortAgentsByID()
-{
-    std::sort(agents_.begin(),
-              agents_.end(),
-              [](const Agent &lhs, const Agent &rhs) -> bool
-              {
-                  return lhs.id < rhs.id;
-              });
-}
-
-void SpyOpt::validateConfig() const
-{
-        if (config_.num_agents <= 0 || config_.num_high_rank <= 0 || config_.num_mid_rank <= 0)
-        {
-            throw std::runtime_error(
-                "[Error] 'num_agent', 'num_hign_rank' and 'num_mid_rank' should be greater than zero.");
-        }
-        if (config_.num_agents <= config_.num_high_rank + config_.num_mid_rank)
-        {
-            throw std::runtime_error(
-                "[Error] 'num_agent' should be greater than (num_high_rank + num_mid_rank).");
-        }
-        if (config_.num_iterations <= 0)
-        {
-            throw std::runtime_error(
-                "[Error] 'num_iteration' should be greater than zero.");
-        }
-        if (config_.lower_bounds.size() != config_.upper_bounds.size())
-        {
-            throw std::runtime_error(
-                "[Error] 'lower_bounds' and 'upper_bounds' should have the same length.");
-        }
-        // Ensure upper_bound > lower_bound
-        for (size_t i = 0, n = config_.lower_bounds.size(); i < n; ++i)
-        {
-            if (config_.upper_bounds[i] <= config_.lower_bounds[i])
-            {
-                throw std::runtime_error(
-                    "[Error] 'upper_bounds' should be greater than 'lower_bounds'.");
-            }
-        }
-}
-
 void SpyOpt::printProgress(size_t iteration)
 {
     // convert zero-origin to one-origin
@@ -292,10 +579,163 @@ void SpyOpt::printProgress(size_t iteration)
     }
 }
 
+void SpyOpt::reserveHistory()
+{
+    const size_t dim = config_.input_dim;
+    best_fitness_history_.reserve(config_.num_iterations);
+    best_pos_history_.reserve(config_.num_iterations * dim);
+    agents_fitness_history_.reserve(config_.num_iterations * config_.num_agents);
+    agents_pos_history_.reserve(config_.num_iterations * config_.num_agents * dim);
+}
+
 void SpyOpt::updateHistory()
 {
+    const size_t dim = config_.input_dim;
+    const auto &best_pos = agents_.front().getPosition();
     best_fitness_history_.emplace_back(agents_.front().fitness);
-    best_pos_history_.emplace_back(agents_.front().getPosition());
+    best_pos_history_.insert(best_pos_history_.end(), best_pos.begin(), best_pos.end());
+
+    // Agents are stored by ID, not by rank
+    const size_t fitness_offset = agents_fitness_history_.size();
+    const size_t pos_offset = agents_pos_history_.size();
+    agents_fitness_history_.resize(fitness_offset + config_.num_agents);
+    agents_pos_history_.resize(pos_offset + config_.num_agents * dim);
+    for (const auto &agent : agents_)
+    {
+        agents_fitness_history_[fitness_offset + agent.id] = agent.fitness;
+        const auto &pos = agent.getPosition();
+        std::copy(pos.begin(), pos.end(), agents_pos_history_.begin() + pos_offset + agent.id * dim);
+    }
+}
+
+void SpyOpt::initAdaptiveState()
+{
+    num_high_rank_ = config_.num_high_rank;
+    num_mid_rank_ = config_.num_mid_rank;
+    swing_step_ = config_.swing_factor;
+    success_rates_.fill(TARGET_SUCCESS_RATE);
+    baseline_rates_.fill(TARGET_SUCCESS_RATE);
+
+    double max_range = 0.;
+    for (size_t i = 0, n = config_.lower_bounds.size(); i < n; ++i)
+    {
+        max_range = std::max(max_range, config_.upper_bounds[i] - config_.lower_bounds[i]);
+    }
+    min_swing_step_ = max_range * std::numeric_limits<double>::epsilon();
+    max_swing_step_ = max_range;
+}
+
+void SpyOpt::adaptParameters(const std::array<size_t, 2> &num_success)
+{
+    const std::array<size_t, 2> band_sizes = {num_high_rank_, num_mid_rank_};
+    std::array<double, 2> rates;
+    for (size_t band = 0; band < band_sizes.size(); ++band)
+    {
+        rates[band] = double(num_success[band]) / band_sizes[band];
+        if (iteration_ == 1)
+        {
+            // The first measurement seeds both averages
+            success_rates_[band] = rates[band];
+            baseline_rates_[band] = rates[band];
+            continue;
+        }
+        success_rates_[band] += SUCCESS_RATE_SMOOTHING * (rates[band] - success_rates_[band]);
+        baseline_rates_[band] += BASELINE_SMOOTHING * (rates[band] - baseline_rates_[band]);
+    }
+
+    // Swing step: 1/5th success rule on the high rank band. The swing moves are greedy
+    // in this mode, so the success rate drops and the step shrinks near an optimum.
+    if (rates[0] > TARGET_SUCCESS_RATE)
+    {
+        swing_step_ /= STEP_ADAPT_FACTOR;
+    }
+    else
+    {
+        swing_step_ *= STEP_ADAPT_FACTOR;
+    }
+    swing_step_ = std::clamp(swing_step_, min_swing_step_, max_swing_step_);
+
+    // Rank bands: the raw rates are not comparable (greedy swing vs. non-greedy moves toward
+    // better agents), so each band is measured against its own long-term baseline. One agent
+    // per iteration is shifted to the band that currently beats its baseline by a margin.
+    // Each band keeps at least MIN_BAND_FRACTION of its configured size. The low rank band
+    // only refreshes diversity and its agents are the worst ones, so its size is kept.
+    std::array<double, 2> trends;
+    for (size_t band = 0; band < band_sizes.size(); ++band)
+    {
+        trends[band] = baseline_rates_[band] > 0. ? success_rates_[band] / baseline_rates_[band] : 1.;
+    }
+    const size_t min_high_rank = std::max<size_t>(1, std::ceil(MIN_BAND_FRACTION * config_.num_high_rank));
+    const size_t min_mid_rank = std::max<size_t>(1, std::ceil(MIN_BAND_FRACTION * config_.num_mid_rank));
+    if (trends[0] > trends[1] * (1. + BAND_SHIFT_MARGIN) && num_mid_rank_ > min_mid_rank)
+    {
+        ++num_high_rank_;
+        --num_mid_rank_;
+    }
+    else if (trends[1] > trends[0] * (1. + BAND_SHIFT_MARGIN) && num_high_rank_ > min_high_rank)
+    {
+        --num_high_rank_;
+        ++num_mid_rank_;
+    }
+}
+
+bool SpyOpt::isRefinementDue(size_t iteration) const
+{
+    if (local_search_.getMethod() == LocalSearchMethod::None)
+    {
+        return false;
+    }
+    const bool scheduled = config_.refinement_interval > 0 && iteration % config_.refinement_interval == 0;
+    const bool stalled = config_.refinement_stall > 0 && num_stalled_iterations_ >= config_.refinement_stall;
+    return scheduled || stalled;
+}
+
+void SpyOpt::refineEliteAgents(double initial_step)
+{
+    try
+    {
+        for (size_t i = 0; i < config_.num_refined_agents; ++i)
+        {
+            const size_t budget = std::min(config_.refinement_evaluations, this->getRemainingEvaluations());
+            if (budget == 0)
+            {
+                break;
+            }
+            Agent &agent = agents_[i];
+            // Counted per call, so the evaluations stay counted if the objective throws
+            const LocalSearchResult result = local_search_.refine(agent.getPosition(), agent.fitness,
+                                                                  initial_step, budget, num_evaluations_);
+            if (result.fitness < agent.fitness)
+            {
+                agent.relocate(result.position, result.fitness);
+            }
+            refined_agents_[agent.id] = true;
+        }
+    }
+    catch (...)
+    {
+        // Keep the agents refined so far, in rank order. The stall counter is kept, so a
+        // refinement triggered by a stall is tried again in the next iteration.
+        this->sortAgentsByFitness();
+        throw;
+    }
+    num_stalled_iterations_ = 0;
+    this->sortAgentsByFitness();
+    best_fitness_so_far_ = std::min(best_fitness_so_far_, agents_.front().fitness);
+}
+
+bool SpyOpt::isSwingGreedy(const Agent &agent) const
+{
+    return config_.adaptive_control || refined_agents_[agent.id];
+}
+
+size_t SpyOpt::getRemainingEvaluations() const
+{
+    if (config_.max_evaluations == 0)
+    {
+        return std::numeric_limits<size_t>::max();
+    }
+    return config_.max_evaluations > num_evaluations_ ? config_.max_evaluations - num_evaluations_ : 0;
 }
 
 } // namespace spy_opt
\ No newline at end of file
@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "SpyOpt/spy_opt.h"
+#include "SpyOpt/spy_opt_c.h"
+
+using spy_opt::Config;
+using spy_opt::SpyOpt;
+
+struct spyopt_t
+{
+    std::unique_ptr<SpyOpt> opt;
+};
+
+namespace
+{
+
+thread_local std::string last_error;
+
+int fail(const std::string &message)
+{
+    last_error = message;
+    return SPYOPT_ERROR;
+}
+
+// Run 'func' and turn any exception into SPYOPT_ERROR.
+template <typename Func>
+int guard(Func func)
+{
+    try
+    {
+        func();
+        return SPYOPT_OK;
+    }
+    catch (const std::exception &e)
+    {
+        return fail(e.what());
+    }
+    catch (...)
+    {
+        return fail("[Error] Unknown exception.");
+    }
+}
+
+Config toConfig(const spyopt_config_t &c_config)
+{
+    if (c_config.input_dim == 0 || c_config.lower_bounds == nullptr || c_config.upper_bounds == nullptr)
+    {
+        throw std::runtime_error("[Error] 'input_dim', 'lower_bounds' and 'upper_bounds' should be given.");
+    }
+    Config config;
+    config.objective_func_name = "C API";
+    config.num_agents = c_config.num_agents;
+    config.num_high_rank = c_config.num_high_rank;
+    config.num_mid_rank = c_config.num_mid_rank;
+    config.num_iterations = c_config.num_iterations;
+    config.swing_factor = c_config.swing_factor;
+    config.input_dim = c_config.input_dim;
+    config.lower_bounds.assign(c_config.lower_bounds, c_config.lower_bounds + c_config.input_dim);
+    config.upper_bounds.assign(c_config.upper_bounds, c_config.upper_bounds + c_config.input_dim);
+    config.adaptive_control = c_config.adaptive_control != 0;
+    config.refinement_method = c_config.refinement_method != nullptr ? c_config.refinement_method : "None";
+    config.refinement_interval = c_config.refinement_interval;
+    config.refinement_stall = c_config.refinement_stall;
+    config.num_refined_agents = c_config.num_refined_agents;
+    config.refinement_evaluations = c_config.refinement_evaluations;
+    config.max_evaluations = c_config.max_evaluations;
+    if (c_config.use_seed)
+    {
+        config.seed = c_config.seed;
+    }
+    config.verbose = c_config.verbose != 0;
+    return config;
+}
+
+const double *historyView(const std::vector<double> &history, size_t row_size, size_t *num_rows)
+{
+    if (num_rows != nullptr)
+    {
+        *num_rows = history.size() / row_size;
+    }
+    return history.data();
+}
+
+} // namespace
+
+extern "C" {
+
+void spyopt_config_init(spyopt_config_t *config)
+{
+    if (config == nullptr)
+    {
+        return;
+    }
+    *config = spyopt_config_t{};
+    config->num_agents = 100;
+    config->num_high_rank = 20;
+    config->num_mid_rank = 60;
+    config->num_iterations = 50;
+    config->swing_factor = 0.3;
+    config->refinement_method = "None";
+    config->refinement_stall = 5;
+    config->num_refined_agents = 1;
+    config->refinement_evaluations = 100;
+    config->verbose = 0;
+}
+
+spyopt_t *spyopt_create(const spyopt_config_t *config, spyopt_objective_fn objective_func, void *user_data)
+{
+    if (config == nullptr || objective_func == nullptr)
+    {
+        fail("[Error] 'config' and 'objective_func' should not be NULL.");
+        return nullptr;
+    }
+    auto handle = std::make_unique<spyopt_t>();
+    const int status = guard([&]()
+    {
+        handle->opt = std::make_unique<SpyOpt>(
+            toConfig(*config),
+            [objective_func, user_data](const std::vector<double> &pos) -> double
+            {
+                return objective_func(pos.data(), pos.size(), user_data);
+            });
+    });
+    return status == SPYOPT_OK ? handle.release() : nullptr;
+}
+
+spyopt_t *spyopt_create_batch(const spyopt_config_t *config, spyopt_batch_objective_fn batch_objective_func,
+                              void *user_data)
+{
+    if (config == nullptr || batch_objective_func == nullptr)
+    {
+        fail("[Error] 'config' and 'batch_objective_func' should not be NULL.");
+        return nullptr;
+    }
+    auto handle = std::make_unique<spyopt_t>();
+    const int status = guard([&]()
+    {
+        handle->opt = std::make_unique<SpyOpt>(
+            toConfig(*config),
+            spy_opt::BatchObjectiveFunction(
+                [batch_objective_func, user_data](const double *positions, size_t num_positions, size_t dim,
+                                                  double *fitness)
+                {
+                    const int code = batch_objective_func(positions, num_positions, dim, fitness, user_data);
+                    if (code != 0)
+                    {
+                        throw std::runtime_error(
+                            "[Error] Batch objective function failed with code " + std::to_string(code) + ".");
+                    }
+                }));
+    });
+    return status == SPYOPT_OK ? handle.release() : nullptr;
+}
+
+spyopt_t *spyopt_create_ask_tell(const spyopt_config_t *config)
+{
+    if (config == nullptr)
+    {
+        fail("[Error] 'config' should not be NULL.");
+        return nullptr;
+    }
+    auto handle = std::make_unique<spyopt_t>();
+    const int status = guard([&]() { handle->opt = std::make_unique<SpyOpt>(toConfig(*config)); });
+    return status == SPYOPT_OK ? handle.release() : nullptr;
+}
+
+void spyopt_destroy(spyopt_t *opt)
+{
+    delete opt;
+}
+
+int spyopt_optimize(spyopt_t *opt)
+{
+    if (opt == nullptr)
+    {
+        return fail("[Error] 'opt' should not be NULL.");
+    }
+    return guard([&]() { opt->opt->optimize(); });
+}
+
+int spyopt_step(spyopt_t *opt, size_t num_steps, size_t *num_done)
+{
+    if (opt == nullptr)
+    {
+        return fail("[Error] 'opt' should not be NULL.");
+    }
+    size_t done = 0;
+    const int status = guard([&]()
+    {
+        while (done < num_steps && opt->opt->step())
+        {
+            ++done;
+        }
+    });
+    if (num_done != nullptr)
+    {
+        *num_done = done;
+    }
+    return status;
+}
+
+int spyopt_reset(spyopt_t *opt)
+{
+    if (opt == nullptr)
+    {
+        return fail("[Error] 'opt' should not be NULL.");
+    }
+    return guard([&]() { opt->opt->reset(); });
+}
+
+const double *spyopt_ask(spyopt_t *opt, size_t *num_candidates)
+{
+    if (opt == nullptr)
+    {
+        fail("[Error] 'opt' should not be NULL.");
+        return nullptr;
+    }
+    const double *candidates = nullptr;
+    const int status = guard([&]() { candidates = opt->opt->ask().data(); });
+    if (num_candidates != nullptr)
+    {
+        *num_candidates = status == SPYOPT_OK ? opt->opt->getConfig().num_agents : 0;
+    }
+    return status == SPYOPT_OK ? candidates : nullptr;
+}
+
+int spyopt_tell(spyopt_t *opt, const double *fitness, size_t num_fitness)
+{
+    if (opt == nullptr || fitness == nullptr)
+    {
+        return fail("[Error] 'opt' and 'fitness' should not be NULL.");
+    }
+    return guard([&]() { opt->opt->tell(fitness, num_fitness); });
+}
+
+int spyopt_finished(const spyopt_t *opt)
+{
+    return opt == nullptr || opt->opt->isFinished();
+}
+
+int spyopt_get_best(const spyopt_t *opt, double *fitness, double *position)
+{
+    if (opt == nullptr)
+    {
+        return fail("[Error] 'opt' should not be NULL.");
+    }
+    return guard([&]()
+    {
+        const auto [best_fitness, best_pos] = opt->opt->getBestFitness();
+        if (fitness != nullptr)
+        {
+            *fitness = best_fitness;
+        }
+        if (position != nullptr)
+        {
+            std::copy(best_pos.begin(), best_pos.end(), position);
+        }
+    });
+}
+
+size_t spyopt_num_evaluations(const spyopt_t *opt)
+{
+    return opt != nullptr ? opt->opt->getNumEvaluations() : 0;
+}
+
+size_t spyopt_iteration(const spyopt_t *opt)
+{
+    return opt != nullptr ? opt->opt->getIteration() : 0;
+}
+
+size_t spyopt_input_dim(const spyopt_t *opt)
+{
+    return opt != nullptr ? opt->opt->getConfig().input_dim : 0;
+}
+
+size_t spyopt_num_agents(const spyopt_t *opt)
+{
+    return opt != nullptr ? opt->opt->getConfig().num_agents : 0;
+}
+
+const double *spyopt_best_fitness_history(const spyopt_t *opt, size_t *num_rows)
+{
+    if (opt == nullptr)
+    {
+        return nullptr;
+    }
+    return historyView(opt->opt->getBestFitnessHistory(), 1, num_rows);
+}
+
+const double *spyopt_best_position_history(const spyopt_t *opt, size_t *num_rows)
+{
+    if (opt == nullptr)
+    {
+        return nullptr;
+    }
+    return historyView(opt->opt->getBestPositionHistory(), opt->opt->getConfig().input_dim, num_rows);
+}
+
+const double *spyopt_agents_fitness_history(const spyopt_t *opt, size_t *num_rows)
+{
+    if (opt == nullptr)
+    {
+        return nullptr;
+    }
+    return historyView(opt->opt->getAgentsFitnessHistory(), opt->opt->getConfig().num_agents, num_rows);
+}
+
+const double *spyopt_agents_position_history(const spyopt_t *opt, size_t *num_rows)
+{
+    if (opt == nullptr)
+    {
+        return nullptr;
+    }
+    const Config &config = opt->opt->getConfig();
+    return historyView(opt->opt->getAgentsPositionHistory(), config.num_agents * config.input_dim, num_rows);
+}
+
+const char *spyopt_last_error(void)
+{
+    return last_error.c_str();
+}
+
+} // extern "C"
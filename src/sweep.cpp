@@ -0,0 +1,503 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "SpyOpt/sweep.h"
+
+namespace spy_opt
+{
+
+namespace
+{
+
+SweepStatistics computeStatistics(std::vector<double> values)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    if (values.empty())
+    {
+        return {nan, nan, nan, nan, nan};
+    }
+    std::sort(values.begin(), values.end());
+    const size_t n = values.size();
+    const double mean = std::accumulate(values.begin(), values.end(), 0.) / n;
+    double sq_sum = 0.;
+    for (const auto &v : values)
+    {
+        sq_sum += (v - mean) * (v - mean);
+    }
+    const double stddev = n > 1 ? std::sqrt(sq_sum / (n - 1)) : 0.;
+    const double median = n % 2 == 1 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+    return {mean, stddev, values.front(), median, values.back()};
+}
+
+std::string quoteCsv(const std::string &text)
+{
+    std::string quoted = "\"";
+    for (const char c : text)
+    {
+        quoted += c == '"' ? "\"\"" : std::string(1, c);
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+std::ostream& operator<<(std::ostream &os, const SweepConfig &sweep_config)
+{
+    os << "SweepConfig:";
+    os << "\n  base_config: " << sweep_config.base_config_path;
+    os << "\n  num_seeds: " << sweep_config.num_seeds;
+    os << "\n  seed: " << sweep_config.seed;
+    os << "\n  num_threads: " << sweep_config.num_threads;
+    os << "\n  prune_after: " << sweep_config.prune_after;
+    os << "\n  num_random_samples: " << sweep_config.num_random_samples;
+    os << "\n  output: " << sweep_config.output_path;
+    for (const auto &[name, values] : sweep_config.grid)
+    {
+        os << "\n  grid." << name << ": [";
+        for (auto it = values.begin(); it != values.end(); ++it)
+        {
+            if (it != values.begin())
+            {
+                os << ", ";
+            }
+            os << *it;
+        }
+        os << "]";
+    }
+    for (const auto &[name, range] : sweep_config.random_ranges)
+    {
+        os << "\n  random." << name << ": [" << range.first << ", " << range.second << "]";
+    }
+    return os;
+}
+
+/* Public methods */
+
+HyperparameterSweep::HyperparameterSweep(const Config &base_config,
+                                         const SweepConfig &sweep_config,
+                                         std::function<double(const std::vector<double>&)> objective_func)
+                                         : sweep_config_(sweep_config), objective_func_(objective_func)
+{
+    if (sweep_config_.num_seeds == 0)
+    {
+        throw std::runtime_error("[Error] 'num_seeds' should be greater than zero.");
+    }
+    if (!sweep_config_.random_ranges.empty() && sweep_config_.num_random_samples == 0)
+    {
+        throw std::runtime_error("[Error] 'num_random_samples' should be greater than zero when 'random' is given.");
+    }
+    for (const auto &[name, values] : sweep_config_.grid)
+    {
+        if (!isSweepableParameter(name) || values.empty())
+        {
+            throw std::runtime_error("[Error] Invalid grid parameter: '" + name + "'.");
+        }
+    }
+    for (const auto &[name, range] : sweep_config_.random_ranges)
+    {
+        const bool integer_range = !isIntegerParameter(name) || std::ceil(range.first) <= std::floor(range.second);
+        if (!isSweepableParameter(name) || range.second < range.first || !integer_range)
+        {
+            throw std::runtime_error("[Error] Invalid random parameter: '" + name + "'.");
+        }
+    }
+    this->expandConfigs(base_config);
+    if (results_.empty())
+    {
+        throw std::runtime_error("[Error] The sweep has no valid configuration.");
+    }
+}
+
+void HyperparameterSweep::run()
+{
+    next_job_ = 0;
+    num_finished_jobs_ = 0;
+    for (auto &result : results_)
+    {
+        result.fitness.clear();
+        result.evaluations.clear();
+        result.stats = computeStatistics(result.fitness);
+        result.mean_evaluations = 0.;
+        result.pruned = false;
+        result.error.clear();
+    }
+
+    size_t num_threads = sweep_config_.num_threads;
+    if (num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::cout << "Running " << results_.size() << " configurations x "
+              << sweep_config_.num_seeds << " seeds on " << num_threads << " threads." << std::endl;
+
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        workers.emplace_back(&HyperparameterSweep::runWorker, this);
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    std::cout << std::endl;
+    for (size_t id = 0, n = results_.size(); id < n; ++id)
+    {
+        if (!results_[id].error.empty())
+        {
+            std::cerr << "[Warning] Configuration " << id << " failed: " << results_[id].error << std::endl;
+        }
+    }
+}
+
+const std::vector<SweepResult>& HyperparameterSweep::getResults() const
+{
+    return results_;
+}
+
+void HyperparameterSweep::printBestConfig() const
+{
+    std::vector<const SweepResult *> finished;
+    for (const auto &result : results_)
+    {
+        if (!result.pruned && result.error.empty() && !result.fitness.empty())
+        {
+            finished.emplace_back(&result);
+        }
+    }
+    if (finished.empty())
+    {
+        std::cout << "No configuration finished." << std::endl;
+        return;
+    }
+
+    // A larger budget wins on fitness alone, so the best configuration is reported per budget:
+    // groups of configurations whose mean evaluations are within PRUNE_BUDGET_TOLERANCE of the smallest.
+    std::sort(finished.begin(), finished.end(), [](const SweepResult *lhs, const SweepResult *rhs)
+    {
+        return lhs->mean_evaluations < rhs->mean_evaluations;
+    });
+    std::vector<const SweepResult *> best_per_budget;
+    double group_evaluations = -1.;
+    for (const auto *result : finished)
+    {
+        if (best_per_budget.empty() ||
+            result->mean_evaluations > group_evaluations * (1. + PRUNE_BUDGET_TOLERANCE))
+        {
+            group_evaluations = result->mean_evaluations;
+            best_per_budget.emplace_back(result);
+        }
+        else if (result->stats.mean < best_per_budget.back()->stats.mean)
+        {
+            best_per_budget.back() = result;
+        }
+    }
+    if (best_per_budget.size() > 1)
+    {
+        std::cout << "Budgets differ: the best configuration of each budget is shown." << std::endl;
+    }
+    for (const auto *best : best_per_budget)
+    {
+        std::cout << "Best configuration (mean fitness: " << best->stats.mean
+                  << ", mean evaluations: " << best->mean_evaluations << "):" << std::endl;
+        std::cout << best->config << std::endl;
+    }
+}
+
+void HyperparameterSweep::dumpResults(const std::string &filename) const
+{
+    std::ofstream file(filename);
+
+    // header
+    file << "config_id,num_agents,num_high_rank,num_mid_rank,num_iterations,swing_factor,adaptive_control,"
+         << "runs,pruned,mean,std,min,median,max,mean_evaluations,error\n";
+
+    for (size_t id = 0, n = results_.size(); id < n; ++id)
+    {
+        const SweepResult &result = results_[id];
+        const SweepStatistics &stats = result.stats;
+        file << id;
+        file << ", " << result.config.num_agents;
+        file << ", " << result.config.num_high_rank;
+        file << ", " << result.config.num_mid_rank;
+        file << ", " << result.config.num_iterations;
+        file << ", " << result.config.swing_factor;
+        file << ", " << result.config.adaptive_control;
+        file << ", " << result.fitness.size();
+        file << ", " << result.pruned;
+        file << ", " << stats.mean;
+        file << ", " << stats.stddev;
+        file << ", " << stats.min;
+        file << ", " << stats.median;
+        file << ", " << stats.max;
+        file << ", " << result.mean_evaluations;
+        file << ", " << quoteCsv(result.error);
+        file << "\n";
+    }
+}
+
+bool HyperparameterSweep::isSweepableParameter(const std::string &name)
+{
+    return name == "num_agents" || name == "num_high_rank" || name == "num_mid_rank" ||
+           name == "num_iterations" || name == "swing_factor" || name == "adaptive_control";
+}
+
+/* Private methods */
+
+bool HyperparameterSweep::isIntegerParameter(const std::string &name)
+{
+    return name != "swing_factor";
+}
+
+void HyperparameterSweep::expandConfigs(const Config &base_config)
+{
+    // Cartesian product of the grid
+    std::vector<Config> configs = {base_config};
+    for (const auto &[name, values] : sweep_config_.grid)
+    {
+        std::vector<Config> expanded;
+        expanded.reserve(configs.size() * values.size());
+        for (const auto &config : configs)
+        {
+            for (const auto &value : values)
+            {
+                Config c = config;
+                setParameter(c, name, value);
+                expanded.emplace_back(c);
+            }
+        }
+        configs = std::move(expanded);
+    }
+
+    std::mt19937 rand_engine(sweep_config_.seed);
+    size_t num_invalid = 0;
+    std::string first_invalid_reason;
+    for (const auto &grid_config : configs)
+    {
+        const std::vector<Config> samples = this->sampleRandomRanges(grid_config, rand_engine);
+        for (auto config : samples)
+        {
+            try
+            {
+                SpyOpt::validateConfig(config);
+            }
+            catch (const std::exception &e)
+            {
+                if (num_invalid++ == 0)
+                {
+                    first_invalid_reason = e.what();
+                }
+                continue;
+            }
+            config.verbose = false;
+            SweepResult result;
+            result.config = config;
+            result.fitness.reserve(sweep_config_.num_seeds);
+            result.evaluations.reserve(sweep_config_.num_seeds);
+            result.stats = computeStatistics(result.fitness);
+            results_.emplace_back(std::move(result));
+        }
+    }
+    if (num_invalid > 0)
+    {
+        std::cerr << "[Warning] Skipped " << num_invalid << " invalid configurations. First reason: "
+                  << first_invalid_reason << std::endl;
+    }
+}
+
+std::vector<Config> HyperparameterSweep::sampleRandomRanges(const Config &config, std::mt19937 &rand_engine) const
+{
+    if (sweep_config_.random_ranges.empty())
+    {
+        return {config};
+    }
+    std::vector<Config> samples;
+    samples.reserve(sweep_config_.num_random_samples);
+    for (size_t i = 0; i < sweep_config_.num_random_samples; ++i)
+    {
+        Config c = config;
+        for (const auto &[name, range] : sweep_config_.random_ranges)
+        {
+            if (isIntegerParameter(name))
+            {
+                // Every integer in the range is equally likely
+                std::uniform_int_distribution<long long> uniform_dist(std::llround(std::ceil(range.first)),
+                                                                      std::llround(std::floor(range.second)));
+                setParameter(c, name, double(uniform_dist(rand_engine)));
+            }
+            else
+            {
+                std::uniform_real_distribution<> uniform_dist(range.first, range.second);
+                setParameter(c, name, uniform_dist(rand_engine));
+            }
+        }
+        samples.emplace_back(c);
+    }
+    return samples;
+}
+
+void HyperparameterSweep::setParameter(Config &config, const std::string &name, double value)
+{
+    // Integer parameters are rounded
+    const auto to_size = [](double v) -> size_t
+    {
+        return static_cast<size_t>(std::llround(std::max(0., v)));
+    };
+    if (name == "num_agents")
+    {
+        config.num_agents = to_size(value);
+    }
+    else if (name == "num_high_rank")
+    {
+        config.num_high_rank = to_size(value);
+    }
+    else if (name == "num_mid_rank")
+    {
+        config.num_mid_rank = to_size(value);
+    }
+    else if (name == "num_iterations")
+    {
+        config.num_iterations = to_size(value);
+    }
+    else if (name == "swing_factor")
+    {
+        config.swing_factor = value;
+    }
+    else if (name == "adaptive_control")
+    {
+        config.adaptive_control = value >= 0.5;
+    }
+    else
+    {
+        throw std::runtime_error("[Error] Unknown sweep parameter: '" + name + "'.");
+    }
+}
+
+void HyperparameterSweep::runWorker()
+{
+    const size_t num_configs = results_.size();
+    const size_t num_jobs = num_configs * sweep_config_.num_seeds;
+    while (true)
+    {
+        size_t config_id, seed_id;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (next_job_ < num_jobs && (results_[next_job_ % num_configs].pruned ||
+                                            !results_[next_job_ % num_configs].error.empty()))
+            {
+                ++next_job_;
+            }
+            if (next_job_ >= num_jobs)
+            {
+                return;
+            }
+            config_id = next_job_ % num_configs;
+            seed_id = next_job_ / num_configs;
+            ++next_job_;
+        }
+
+        Config config = results_[config_id].config;
+        config.seed = sweep_config_.seed + static_cast<unsigned int>(seed_id);
+        double fitness = 0.;
+        size_t num_evaluations = 0;
+        std::string error;
+        try
+        {
+            SpyOpt spy_alg(config, objective_func_);
+            spy_alg.optimize();
+            fitness = spy_alg.getBestFitness().first;
+            num_evaluations = spy_alg.getNumEvaluations();
+        }
+        catch (const std::exception &e)
+        {
+            error = e.what();
+        }
+        catch (...)
+        {
+            error = "[Error] Unknown exception.";
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++num_finished_jobs_;
+        if (error.empty())
+        {
+            this->addRun(config_id, fitness, num_evaluations);
+            this->updatePruning(config_id);
+        }
+        else if (results_[config_id].error.empty())
+        {
+            // The remaining runs of this configuration are skipped
+            results_[config_id].error = error;
+        }
+        std::cout << "\rFinished " << num_finished_jobs_ << " runs" << std::flush;
+    }
+}
+
+void HyperparameterSweep::addRun(size_t config_id, double fitness, size_t num_evaluations)
+{
+    SweepResult &result = results_[config_id];
+    result.fitness.emplace_back(fitness);
+    result.evaluations.emplace_back(num_evaluations);
+    result.stats = computeStatistics(result.fitness);
+    result.mean_evaluations =
+        double(std::accumulate(result.evaluations.begin(), result.evaluations.end(), size_t(0)))
+        / result.evaluations.size();
+}
+
+void HyperparameterSweep::updatePruning(size_t config_id)
+{
+    // Only the statistics of 'config_id' changed, so it is tested against its budget peers
+    // and the peers against it. The pairs without it were already tested.
+    SweepResult &result = results_[config_id];
+    if (sweep_config_.prune_after == 0 || !this->isPruningCandidate(result))
+    {
+        return;
+    }
+    for (auto &other : results_)
+    {
+        if (&other == &result || !this->isPruningCandidate(other))
+        {
+            continue;
+        }
+        if (isDominated(result, other))
+        {
+            result.pruned = true;
+            return;
+        }
+        if (isDominated(other, result))
+        {
+            other.pruned = true;
+        }
+    }
+}
+
+bool HyperparameterSweep::isPruningCandidate(const SweepResult &result) const
+{
+    return !result.pruned && result.error.empty() && result.fitness.size() >= sweep_config_.prune_after;
+}
+
+bool HyperparameterSweep::isDominated(const SweepResult &result, const SweepResult &other)
+{
+    // Compared only at about the same evaluation budget, so that a configuration is not
+    // pruned for spending fewer evaluations.
+    const double tolerance = PRUNE_BUDGET_TOLERANCE * std::max(result.mean_evaluations, other.mean_evaluations);
+    if (std::abs(result.mean_evaluations - other.mean_evaluations) > tolerance)
+    {
+        return false;
+    }
+
+    // One-sided z-test on the difference of the means. The larger standard deviation is used
+    // for both, since a few lucky runs can make one look much tighter than it is.
+    const double stddev = std::max(result.stats.stddev, other.stats.stddev);
+    const double standard_error = stddev * std::sqrt(1. / result.fitness.size() + 1. / other.fitness.size());
+    return result.stats.mean - other.stats.mean > PRUNE_CONFIDENCE_Z * standard_error;
+}
+
+} // namespace spy_opt